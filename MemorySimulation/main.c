@@ -6,76 +6,516 @@
  * techniques including First Fit, Best Fit, and Worst Fit.
  *
  * Compilation:
- * gcc static_memory_allocation.c -o static_memory_allocation -Wall
+ * gcc static_memory_allocation.c -o static_memory_allocation -Wall -pthread
  *
  * Usage:
  * ./static_memory_allocation [input_file]
  *
  *****************************************************************************/
 
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <time.h>
 #include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
 
 
 
 /* Constants */
-#define MAX_BLOCKS 100     // Maximum number of memory blocks
-#define MAX_PROCESSES 20   // Maximum number of processes
+#define INITIAL_BLOCK_CAPACITY 64 // Block array entries allocated up front; the array doubles as needed
+#define INITIAL_PROCESS_CAPACITY 32 // Process table entries allocated up front; the table doubles as needed
 #define MEM_VISUAL_SIZE 60 // Memory visualization size
+#define MEM_MAP_SAMPLES 8  // Occupancy samples per memory map cell
+#define MAX_LISTED_BLOCKS 40 // Longer block lists are summarized by the memory map
+#define DEFAULT_SPLIT_THRESHOLD_BYTES 10240 // Split a block only if more than this would be left
+#define DEFAULT_MIN_BLOCK_SIZE 1    // Smallest block handed out
+#define DEFAULT_ALIGNMENT 1         // Block sizes and addresses are multiples of this
 #define DEFAULT_INPUT_FILE "input.txt"
 #define MAX_LINE_LENGTH 1024
+#define BITMAP_PAGE_BYTES 4096      // Default page (granule) size for Bitmap Fit
+#define BITMAP_MAX_PAGES (1 << 20)  // Page size doubles until the bitmap fits in this many pages
+#define NUM_STRATEGIES 4            // Number of allocation strategies compared
+#define BENCH_SEED 12345            // Fixed seed so benchmark runs are reproducible
+#define BENCH_OPERATIONS 20000      // Allocate/free operations per benchmark run
+#define BENCH_SLOTS 32              // Concurrently tracked processes in the benchmark
+#define MAX_BRANCHES 8              // Maximum what-if branches per strategy
+#define SNAPSHOT_MAGIC "MSNP"       // Snapshot record signature
+#define SNAPSHOT_VERSION 4          // 2: 64-bit sizes and addresses, 3: no block owner, 4: merge counters
+#define SNAPSHOT_HEADER_SIZE (4 + 12 * 4 + 5 * 8)
+#define SNAPSHOT_BLOCK_SIZE 17      // start, size, free flag
+#define SNAPSHOT_PROCESS_SIZE 17    // id, size, block index, state
+#define ADAPTIVE_CANDIDATES 3       // Shadowed placement policies (the block-list fits)
+#define ADAPTIVE_WINDOW 16          // Events in the sliding comparison window
+#define ADAPTIVE_PATIENCE 4         // Consecutive wins needed before switching
+#define ADAPTIVE_FRAG_MARGIN 5.0    // Fragmentation lead (percentage points) that counts as a win
+#define MAX_SWITCH_LOG 32           // Switch decisions kept for the report
+#define COALESCE_THRESHOLD 8        // Deferred coalescing: merge after this many frees
+#define REUSE_LIST_SIZE 16          // Deferred coalescing: freed blocks kept for quick reuse
+#define LATENCY_SUB_BITS 5          // Latency histogram precision: 2^4 sub-buckets per power of two (3-6% wide)
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS + (64 - LATENCY_SUB_BITS) * (LATENCY_SUB_BUCKETS / 2))
+#define PAGING_PAGE_BYTES 4096      // Default virtual page / frame size
+#define PAGING_REFERENCES 10000000  // Synthetic trace length when no --trace is given
+#define PAGING_BURST 1000           // Synthetic trace: consecutive references per process
+#define PAGING_MAX_FRAMES (1 << 24) // Upper bound on the frame pool
+#define PAGING_DEFAULT_FRAMES_PERCENT 25 // Default frame pool, as a share of all pages, so policies must evict
+#define PAGING_POOL_ID 0            // Process ID of the frame pool block
+#define TLB_SETS 16                 // TLB sets (power of two)
+#define TLB_WAYS 4                  // TLB associativity
+#define MAX_NUMA_NODES 8            // Maximum NUMA nodes
+#define NUMA_LOCAL_DISTANCE 10      // Default distance to the local node (SLIT convention)
+#define NUMA_REMOTE_DISTANCE 20     // Default distance between neighbouring nodes
+#define NUMA_SPILL_WATERMARK 0.75   // Spill-over: keep home nodes below this utilization
+#define QUEUE_INITIAL_CAPACITY 16   // Admission queue entries before the first resize
+#define QUEUE_STARVATION_WAIT 1000  // Admission queue: waits longer than this many operations count as starved
+#define SEARCH_POPULATION 32        // Workloads kept by the adversarial search
+#define SEARCH_GENERATIONS 200      // Default generations (--generations)
+#define SEARCH_HORIZON 100          // Search: arrivals and durations are drawn from [0, horizon]
+#define SEARCH_CROSSOVER_PERCENT 30 // Search: children built by crossover rather than copying one parent
+#define SEARCH_KEEP 3               // Worst traces written out
+#define SEARCH_SEED 2024            // Fixed seed so searches are reproducible
+#define MAX_SEARCH_THREADS 64       // Upper bound on evaluation threads
+#define SEARCH_CHUNK 2              // Candidates a thread claims at a time
+#define SEARCH_MIN_PER_THREAD 4     // Default thread count leaves each thread at least this many candidates
+#define LIFETIME_TRAINING_PERCENT 25 // Lifetime predictor: share of the trace (by arrival) it learns from
+#define LIFETIME_SIZE_CLASSES 64    // Lifetime predictor: power-of-two size classes
+#define LIFETIME_MIN_SAMPLES 8      // Lifetime predictor: a shorter training prefix leaves it untrained
+#define SWAP_INITIAL_CAPACITY 16    // Backing store entries before the first resize
+
+/* Addresses and sizes, in allocation units (64-bit so byte-granular TB pools fit) */
+typedef long long MemSize;
 
 /* Global variables*/
-int memory_size; // Total memory size (in KB)
+MemSize memory_size;       // Total memory size (in allocation units)
+int allocation_unit = 1024; // Bytes per allocation unit (--unit); 1024 keeps sizes in KB
 
 /* Allocation strategies */
 typedef enum
 {
     FIRST_FIT,
     BEST_FIT,
-    WORST_FIT
+    WORST_FIT,
+    BITMAP_FIT
 } AllocationStrategy;
 
+/* Coalescing policies */
+typedef enum
+{
+    COALESCE_IMMEDIATE, // Merge free neighbours on every free
+    COALESCE_DEFERRED   // Keep freed blocks for reuse, merge in batches
+} CoalescePolicy;
+
+/* Request ordering for batch allocation */
+typedef enum
+{
+    BATCH_ORDER_INPUT,     // Keep arrival order
+    BATCH_ORDER_DECREASING // Largest first (First/Best/Worst Fit Decreasing)
+} BatchOrder;
+
+/* Page replacement policies for paged mode */
+typedef enum
+{
+    REPLACE_LRU,   // Evict the least recently used page
+    REPLACE_CLOCK, // Second chance with one reference bit per frame
+    REPLACE_ARC,   // Adaptive Replacement Cache (recency vs frequency, ghost lists)
+    NUM_REPLACEMENT_POLICIES
+} ReplacementPolicy;
+
+/* Page lists; LRU uses only the recent list */
+typedef enum
+{
+    PAGE_LIST_RECENT,         // ARC T1: resident, referenced once
+    PAGE_LIST_FREQUENT,       // ARC T2: resident, referenced again
+    PAGE_LIST_RECENT_GHOST,   // ARC B1: evicted from T1
+    PAGE_LIST_FREQUENT_GHOST, // ARC B2: evicted from T2
+    NUM_PAGE_LISTS,
+    PAGE_LIST_NONE = NUM_PAGE_LISTS
+} PageListId;
+
+/* NUMA placement policies */
+typedef enum
+{
+    NUMA_LOCAL_FIRST, // Home node, then the nearest node with room
+    NUMA_INTERLEAVE,  // Round-robin across nodes
+    NUMA_SPILL_OVER,  // Home node until it passes the watermark, then the nearest node below it
+    NUM_NUMA_POLICIES
+} NumaPolicy;
+
+/* Admission queue policies for requests that could not be placed */
+typedef enum
+{
+    QUEUE_FIFO,           // Admit in arrival order; the head blocks everyone behind it
+    QUEUE_SMALLEST_FIRST, // Admit the smallest waiter first
+    QUEUE_BEST_FIT,       // Admit the largest waiter that fits the hole a free opened
+    NUM_QUEUE_POLICIES
+} QueuePolicy;
+
+/* What the adversarial search maximizes */
+typedef enum
+{
+    SEARCH_FAILURES,     // Allocations that failed although enough total memory was free
+    SEARCH_FRAGMENTATION // Mean external fragmentation seen by arriving requests
+} SearchObjective;
+
+/* How long-lived requests are recognized for lifetime-segregated placement */
+typedef enum
+{
+    LIFETIME_OFF,       // Every request is placed from the bottom
+    LIFETIME_ORACLE,    // Classify by the request's own Duration
+    LIFETIME_PREDICTED, // Classify by the mean Duration of its size class in the trace prefix
+    NUM_LIFETIME_POLICIES
+} LifetimePolicy;
+
+/* Lifetime class a request was given when it was first placed */
+typedef enum
+{
+    LIFETIME_UNCLASSIFIED, // Not placed since the model was trained
+    LIFETIME_SHORT,        // Placed from the bottom of memory
+    LIFETIME_LONG          // Placed from the top of memory
+} LifetimeClass;
+
+/* Which processes are swapped out when a request finds no hole */
+typedef enum
+{
+    SWAP_OLDEST,        // Victims placed longest ago
+    SWAP_LARGEST_FIRST, // The largest process that can open a hole, plus what it takes
+    SWAP_MIN_BYTES,     // The fewest bytes that open a hole
+    NUM_SWAP_POLICIES
+} SwapPolicy;
+
 /* Process states */
 typedef enum
 {
     PROCESS_NEW,
     PROCESS_RUNNING,
-    PROCESS_TERMINATED
+    PROCESS_TERMINATED,
+    PROCESS_WAITING, // In the admission queue
+    PROCESS_SWAPPED  // Swapped out to the backing store
 } ProcessState;
 
-/* Memory block structure */
+/*
+ * Memory block structure, packed into 16 bytes: the free flag is folded into
+ * the top bit of the size word, read and written only through the accessors
+ * below. The owner is not stored; the process table maps processes to block
+ * indices.
+ */
 typedef struct
 {
-    int start_address; // Start address of the block
-    int size;          // Size of the block
-    bool is_free;      // Is the block free?
-    int process_id;    // ID of the process using this block (-1 if free)
+    MemSize start_address; // Start address of the block
+    uint64_t size_word;    // Size in the low 63 bits, free flag in the top bit
 } MemoryBlock;
 
+/* A layout change that grows the block fails the build here */
+typedef char memory_block_is_16_bytes[sizeof(MemoryBlock) == 16 ? 1 : -1];
+
+#define BLOCK_FREE_BIT ((uint64_t)1 << 63) // MemoryBlock.size_word: set if the block is free
+
+/**
+ * Size of a block
+ */
+static inline MemSize get_block_size(const MemoryBlock *block)
+{
+    return (MemSize)(block->size_word & ~BLOCK_FREE_BIT);
+}
+
+/**
+ * Set the size of a block, keeping its free flag
+ */
+static inline void set_block_size(MemoryBlock *block, MemSize size)
+{
+    block->size_word = (block->size_word & BLOCK_FREE_BIT) | ((uint64_t)size & ~BLOCK_FREE_BIT);
+}
+
+/**
+ * Whether a block is free
+ */
+static inline bool is_block_free(const MemoryBlock *block)
+{
+    return (block->size_word & BLOCK_FREE_BIT) != 0;
+}
+
+/**
+ * Set both the size and the free flag of a block
+ */
+static inline void set_block(MemoryBlock *block, MemSize size, bool is_free)
+{
+    block->size_word = ((uint64_t)size & ~BLOCK_FREE_BIT) | (is_free ? BLOCK_FREE_BIT : 0);
+}
+
+/**
+ * Mark a block free or allocated, keeping its size
+ */
+static inline void set_block_free(MemoryBlock *block, bool is_free)
+{
+    block->size_word = is_free ? block->size_word | BLOCK_FREE_BIT : block->size_word & ~BLOCK_FREE_BIT;
+}
+
 /* Process structure */
 typedef struct
 {
     int id;             // Process ID
-    int size;           // Process size in KB
+    MemSize size;       // Process size in allocation units
     ProcessState state; // Process state
     int block_index;    // Index of allocated block (-1 if none)
+    int arrival_time;   // Replay: tick the request arrives
+    int duration;       // Replay: ticks the block is held before it is freed
+    uint64_t placed_at; // Swapping: swap clock when it was last placed
+    LifetimeClass lifetime_class; // Lifetime: class given on first placement, reused on retries
 } Process;
 
-/* Memory manager structure */
+/* Instrumented operation kinds */
+typedef enum
+{
+    OP_ALLOCATE,   // allocate_memory as a whole
+    OP_FIND,       // The strategy's find_* search
+    OP_COALESCE,   // Merging free neighbours after a free
+    OP_DEALLOCATE, // deallocate_memory as a whole
+    NUM_OPERATION_KINDS
+} OperationKind;
+
+/* Log-linear (HDR-style) latency histogram in nanoseconds */
+typedef struct
+{
+    uint64_t counts[LATENCY_BUCKETS]; // Samples per bucket
+    uint64_t total_count;             // Number of samples
+    uint64_t max_value;               // Exact largest sample
+} LatencyHistogram;
+
+/* Per-manager latency recorder; a manager is only used by one thread */
 typedef struct
 {
-    int total_size;                 // Total memory size
-    int free_size;                  // Available free memory
+    LatencyHistogram histograms[NUM_OPERATION_KINDS];
+} LatencyRecorder;
+
+/* Request waiting in the admission queue */
+typedef struct
+{
+    Process *process;     // Waiting process (state PROCESS_WAITING)
+    uint64_t enqueued_at; // Queue clock when it started waiting
+} QueueEntry;
+
+/* Admission queue: failed requests wait here and are retried after frees */
+typedef struct
+{
+    QueuePolicy policy;
+    QueueEntry *entries;       // Waiters in arrival order
+    int count;                 // Number of waiters
+    int capacity;              // Allocated entries
+    MemSize min_request;       // Smallest rounded request waiting, for the cheap retry check
+    uint64_t clock;            // Operations seen: allocation requests and frees
+    uint64_t length_sum;       // Queue length summed over operations, for the average
+    int max_length;            // Longest the queue has been
+    int enqueued;              // Requests that had to wait
+    int admitted;              // Waiters placed after a free
+    int starved;               // Waiters admitted after more than QUEUE_STARVATION_WAIT operations
+    int retries;               // Frees that opened a hole big enough to retry
+    int skipped_retries;       // Frees whose hole was smaller than every waiter
+    LatencyHistogram waits;    // Wait of admitted requests, in operations
+} AdmissionQueue;
+
+/* Replay event: a process arriving or finishing */
+typedef struct
+{
+    int time;    // Tick of the event
+    int phase;   // Order within a tick: 0 = frees, 1 = arrivals, 2 = zero-length frees
+    int process; // Index into the process table
+} ReplayEvent;
+
+/* One workload in the adversarial search */
+typedef struct
+{
+    Process *processes;               // Sizes, arrivals and durations being evolved (own slice)
+    int count;                        // Number of processes
+    double score;                     // Objective lead over the best other strategy; higher is worse
+    double failure_rate;              // Fragmented failures, in percent of attempts
+    double mean_fragmentation;        // Mean fragmentation_percentage over the replay
+    AllocationStrategy rival;         // Other strategy that handled the workload best
+    double rival_failure_rate;        // Its fragmented failures
+    double rival_fragmentation;       // Its mean fragmentation
+} SearchCandidate;
+
+/* Evaluation threads kept alive for the whole search */
+typedef struct
+{
+    pthread_t workers[MAX_SEARCH_THREADS]; // Threads besides the caller
+    int worker_count;                      // Entries used in workers
+    pthread_mutex_t lock;                  // Guards every field below
+    pthread_cond_t work_ready;             // A generation was handed out, or stopping
+    pthread_cond_t work_done;              // The last worker checked out of a generation
+    SearchCandidate *candidates;           // Generation being evaluated
+    int count;                             // Candidates in the generation
+    int next;                              // First candidate not yet claimed
+    int busy;                              // Workers that have not finished the generation
+    unsigned generation;                   // Bumped for every generation handed out
+    bool stopping;                         // Workers exit when set
+    AllocationStrategy strategy;           // Strategy under attack
+    SearchObjective objective;             // What the search maximizes
+} SearchPool;
+
+/* Short/long lifetime classifier for segregated placement */
+typedef struct
+{
+    LifetimePolicy policy;
+    bool trained;                                  // Threshold and classes learned from a workload
+    int threshold;                                 // Durations above this (in ticks) are long-lived
+    double class_duration[LIFETIME_SIZE_CLASSES];  // Predicted: mean prefix Duration per size class
+    int class_samples[LIFETIME_SIZE_CLASSES];      // Predicted: prefix requests per size class
+    int prefix_arrival;                            // Arrival tick of the last training request
+    int prefix_id;                                 // ID of the last training request
+    int short_requests;                            // Requests after the prefix placed from the bottom
+    int long_requests;                             // Requests after the prefix placed from the top
+    int mispredictions;                            // Predicted: class differs from the one Duration gives
+} LifetimeModel;
+
+/* Maximal free address range, as kept in the swap hole index */
+typedef struct
+{
+    MemSize start; // First free address
+    MemSize size;  // Free units up to the next allocated block
+} SwapHole;
+
+/* Running process keyed by its block size, as kept in the swap size index */
+typedef struct
+{
+    MemSize size;     // Units in the process's block
+    Process *process; // The process
+} SwapResident;
+
+/* Window of adjacent blocks whose victims would open a hole */
+typedef struct
+{
+    int first;       // First block of the window
+    int last;        // Last block of the window
+    MemSize bytes;   // Units swapped out
+    int victims;     // Running processes in the window
+    uint64_t newest; // Latest placement among the victims
+    MemSize largest; // Largest victim
+} SwapWindow;
+
+/* Simulated backing store for swapped-out processes */
+typedef struct
+{
+    SwapPolicy policy;
+    Process **swapped;         // Swapped-out processes, oldest first
+    int count;                 // Number of swapped-out processes
+    int capacity;              // Allocated entries
+    bool swapping_in;          // Set while placing swapped processes back; swap-ins never evict
+    uint64_t clock;            // Placements seen; stamps Process.placed_at
+    SwapHole *holes;           // Hole index: free ranges in address order
+    SwapHole *holes_by_size;   // Hole index: the same ranges by size, then address
+    int hole_count;            // Entries in each hole array
+    int hole_capacity;         // Allocated entries in each hole array
+    Process **resident;        // Running processes of the table, in address order
+    SwapResident *resident_by_size; // The same processes by block size, then ID
+    int resident_count;        // Entries in each resident array
+    int resident_capacity;     // Allocated entries in each resident array
+    Process **owner;           // Scratch: owners of swept blocks, then the chosen victims
+    int *queues;               // Scratch: the newest and largest deques of a sweep
+    int scratch_capacity;      // Blocks the scratch arrays hold
+    MemSize store_size;        // Units in the backing store
+    MemSize peak_store_size;   // Most units the backing store has held
+    int swap_outs;             // Processes swapped out
+    int swap_ins;              // Processes swapped back in
+    MemSize bytes_out;         // Swap-out traffic, in units
+    MemSize bytes_in;          // Swap-in traffic, in units
+    int discarded;             // Processes that ended while swapped out
+    int rescued;               // Requests placed after swapping victims out
+    int no_victims;            // Requests no set of victims could make room for
+    int windows_scored;        // Candidate victim windows compared
+} SwapSpace;
+
+/* Page bitmap used by the Bitmap Fit strategy */
+typedef struct
+{
+    uint64_t *words;       // One bit per page, set if the page is allocated
+    uint64_t *full_words;  // Summary: one bit per word, set if the word is fully allocated
+    uint64_t *empty_words; // Summary: one bit per word, set if the word is fully free
+    MemSize page_size;     // Page size in allocation units
+    int page_count;        // Number of whole pages tracked
+    int word_count;        // Number of 64-bit words in words[]
+    int summary_count;     // Number of 64-bit words in each summary array
+} PageBitmap;
+
+/* Memory manager structure */
+typedef struct MemoryManager
+{
+    MemSize total_size;             // Total memory size
+    MemSize free_size;              // Available free memory
     int block_count;                // Number of blocks
-    MemoryBlock blocks[MAX_BLOCKS]; // Array of memory blocks
+    int block_capacity;             // Allocated entries in blocks
+    MemoryBlock *blocks;            // Blocks in address order, grown on demand
     AllocationStrategy strategy;    // Current allocation strategy
+    MemSize internal_fragmentation; // Memory allocated beyond what processes requested
+    MemSize padding_fragmentation;  // Part of it from minimum size, alignment and page rounding
+    MemSize slack_fragmentation;    // Part of it from unsplit remainders
+    MemSize split_threshold;        // Split only if the remainder exceeds this
+    MemSize min_block_size;         // Requests are rounded up to at least this
+    MemSize alignment;              // Requests are rounded up to a multiple of this
+    PageBitmap *bitmap;             // Page bitmap (Bitmap Fit only, NULL otherwise)
+    Process *process_table;         // Processes whose block indices are kept in sync
+    int process_count;              // Number of entries in process_table
+    bool verbose;                   // Print coalescing details
+    struct AdaptiveState *adaptive; // Shadow simulations (adaptive mode only, NULL otherwise)
+    LatencyRecorder *latency;       // Operation latencies (--latency only, NULL otherwise)
+    AdmissionQueue *queue;          // Waiting requests (--queue only, NULL otherwise)
+    LifetimeModel *lifetime;        // Lifetime classes (--lifetime only, NULL otherwise)
+    SwapSpace *swap;                // Backing store (--swap only, NULL otherwise)
+    CoalescePolicy coalesce_policy; // When free neighbours are merged
+    int coalesce_threshold;         // Deferred: frees between batched merges
+    int pending_frees;              // Deferred: frees since the last batched merge
+    MemSize reuse_list[REUSE_LIST_SIZE]; // Deferred: start addresses of recently freed blocks
+    int reuse_count;                // Deferred: entries in reuse_list
+    int merge_count;                // Block merges performed
+    int deferred_merges;            // Block merges performed by batched coalescing
+    int quick_reuse_hits;           // Allocations served from the reuse list
+    long long untimed_ns;           // Verbose output inside timed regions, excluded from latencies
 } MemoryManager;
 
+/* Shadow simulation of one candidate strategy */
+typedef struct
+{
+    MemoryManager manager;                      // Shadow manager fed the primary's events
+    Process *processes;                         // Shadow copy of the process table
+    int process_capacity;                       // Allocated entries in processes
+    bool window_failed[ADAPTIVE_WINDOW];        // Allocation failures over the recent events
+    double window_fragmentation[ADAPTIVE_WINDOW]; // Fragmentation after each recent event
+    int total_failures;                         // Failed allocations since attach
+} ShadowManager;
+
+/* A recorded change of placement policy */
+typedef struct
+{
+    int event;                    // Event number at which the switch happened
+    AllocationStrategy from;      // Previous strategy
+    AllocationStrategy to;        // New strategy
+    int from_failures;            // Windowed failures of the previous strategy's shadow
+    int to_failures;              // Windowed failures of the new strategy's shadow
+    double from_fragmentation;    // Windowed average fragmentation of the previous shadow
+    double to_fragmentation;      // Windowed average fragmentation of the new shadow
+} SwitchDecision;
+
+/* Adaptive strategy selection state */
+typedef struct AdaptiveState
+{
+    ShadowManager shadows[ADAPTIVE_CANDIDATES]; // One shadow per candidate strategy
+    int event_count;                            // Events observed
+    int window_fill;                            // Valid entries in the windows
+    int window_pos;                             // Next window slot to overwrite
+    int leader;                                 // Shadow currently beating the primary (-1 if none)
+    int lead_streak;                            // Consecutive events the leader has led
+    SwitchDecision switches[MAX_SWITCH_LOG];    // Switch decisions (first MAX_SWITCH_LOG)
+    int switch_count;                           // Total switches
+    long long primary_ns;                       // Time spent in primary allocate/free
+    long long shadow_ns;                        // Time spent replaying events into shadows
+} AdaptiveState;
+
 /* Statistics structure */
 typedef struct
 {
@@ -87,21 +527,289 @@ typedef struct
     int external_fragmentation;      // Number of free blocks
     double fragmentation_percentage; // Percentage of memory fragmented
     double avg_fragment_size;        // Average size of fragments
+    MemSize internal_fragmentation;  // Memory allocated beyond requested sizes
+    MemSize padding_fragmentation;   // Internal fragmentation from rounding requests up
+    MemSize slack_fragmentation;     // Internal fragmentation from unsplit remainders
+    int unmerged_free_blocks;        // Free blocks adjacent to another free block
+    int merge_count;                 // Block merges performed
+    int deferred_merges;             // Block merges done by batched coalescing
+    int quick_reuse_hits;            // Allocations served from the reuse list
+    double utilization_sum;          // Sum of utilization samples
+    int utilization_samples;         // Number of utilization samples
+    int fragmented_failures;         // Replay: failures although total free memory sufficed
+    double fragmentation_sum;        // Replay: sum of fragmentation_percentage at each arrival
+    int fragmentation_samples;       // Replay: number of fragmentation samples
 } Statistics;
 
+/* Outcome of a batch allocation compared with sequential placement */
+typedef struct
+{
+    AllocationStrategy strategy; // Strategy used for placement
+    BatchOrder order;            // Order the batch was placed in
+    int requested;               // Requests in the batch
+    int placed;                  // Requests placed by the batch
+    MemSize placed_size;         // Memory placed by the batch
+    MemSize largest_hole;        // Largest free hole after the batch
+    int sequential_placed;       // Requests placed one by one in input order
+    MemSize sequential_size;     // Memory placed one by one in input order
+    MemSize sequential_largest_hole; // Largest free hole after sequential placement
+} BatchReport;
+
+/* Doubly linked list of pages, most recently used at the head */
+typedef struct
+{
+    int32_t head; // MRU page (-1 if empty)
+    int32_t tail; // LRU page (-1 if empty)
+    int32_t size; // Number of pages on the list
+} PageList;
+
+/* Paged virtual memory backed by a frame pool taken from a MemoryManager
+ *
+ * Pages are numbered globally; process i owns pages
+ * [page_table_base[i], page_table_base[i + 1]), so all page tables live in
+ * flat per-page arrays and the replay loop never allocates. */
+typedef struct
+{
+    ReplacementPolicy policy;           // Victim selection
+    MemSize page_size;                  // Page and frame size in allocation units
+    Process pool;                       // Frame pool block allocated from the manager
+    MemSize pool_start;                 // Physical address of frame 0
+    int frame_count;                    // Frames in the pool
+    int frames_used;                    // Frames handed out so far (never returned)
+    int process_count;                  // Number of page tables
+    int *process_ids;                   // Process ID of each page table
+    int32_t *page_table_base;           // First global page of each process (+1 sentinel)
+    int32_t page_count;                 // Pages over all processes
+    int32_t *page_frame;                // Page tables: frame of each page (-1 if not resident)
+    int32_t *page_owner;                // Page table index owning each page
+    uint8_t *page_list;                 // PageListId each page is on
+    int32_t *prev;                      // List links per page
+    int32_t *next;
+    int32_t *frame_page;                // Page held by each frame
+    uint8_t *frame_referenced;          // CLOCK reference bit per frame
+    int clock_hand;                     // CLOCK: next frame to inspect
+    PageList lists[NUM_PAGE_LISTS];     // LRU list, or ARC T1/T2/B1/B2
+    int arc_target;                     // ARC: target size of T1 (p)
+    int32_t tlb[TLB_SETS][TLB_WAYS];    // Cached page + 1 (0 = invalid), MRU way first
+    uint64_t references;                // References replayed
+    uint64_t tlb_hits;                  // Translations served by the TLB
+    uint64_t walk_hits;                 // TLB misses that found the page resident
+    uint64_t faults;                    // References to non-resident pages
+    uint64_t evictions;                 // Pages evicted to make room
+    uint64_t *process_faults;           // Faults per page table
+} PagingSystem;
+
+/* Several memory managers acting as NUMA nodes */
+typedef struct
+{
+    int node_count;                                        // Nodes in use
+    MemoryManager nodes[MAX_NUMA_NODES];                   // One manager per node
+    int distance[MAX_NUMA_NODES][MAX_NUMA_NODES];          // Access cost from CPU node to memory node
+    int nearest[MAX_NUMA_NODES][MAX_NUMA_NODES];           // Nodes ordered by distance from each node
+    NumaPolicy policy;                                     // Placement policy
+    int next_interleave;                                   // Interleave: next node to try first
+    int allocation_attempts;                               // Placement requests
+    int allocations;                                       // Successful placements
+    int remote_allocations;                                // Placements off the home node
+    double weighted_cost;                                  // Sum of size * distance over placements
+    double placed_size;                                    // Sum of placed sizes
+    double utilization_sum[MAX_NUMA_NODES];                // Per-node utilization samples
+    double peak_utilization[MAX_NUMA_NODES];               // Per-node peak utilization
+    int utilization_samples;                               // Samples taken
+} NumaSystem;
+
+/* Serialized simulation state shared between forks */
+typedef struct
+{
+    unsigned char *data; // Serialized manager, process table and statistics
+    size_t size;         // Size of data in bytes
+    int ref_count;       // Number of forks sharing data
+} SimulationSnapshot;
+
+/* Command line options */
+typedef struct
+{
+    const char *save_snapshot_file; // Save state after phase 1 here
+    const char *load_snapshot_file; // Restore state from here instead of running phase 1
+    int branch_count;               // Number of what-if branches after phase 1
+    bool adaptive;                  // Add an adaptive-strategy run
+    bool latency;                   // Record per-operation latency histograms
+    CoalescePolicy coalesce_policy; // Coalescing policy for every manager
+    int coalesce_threshold;         // Frees between batched merges (deferred policy)
+    bool batch;                     // Allocate phase 1 and 3 requests as one batch
+    BatchOrder batch_order;         // Request order within a batch
+    bool paging;                    // Run the paged virtual memory simulation instead
+    bool paging_compare_all;        // Replay the trace under every replacement policy
+    ReplacementPolicy paging_policy; // Replacement policy (unless comparing all)
+    int frame_count;                // Frames in the pool (0 = a quarter of the pages)
+    const char *trace_file;         // Memory-reference trace (NULL = synthetic)
+    int numa_nodes;                 // Run the NUMA simulation with this many nodes (0 = off)
+    bool numa_compare_all;          // Compare every placement policy
+    NumaPolicy numa_policy;         // Placement policy (unless comparing all)
+    const char *numa_distance_file; // Node distance matrix (NULL = default)
+    int map_interval;               // Benchmark: print the memory map every N operations (0 = off)
+    MemSize split_threshold;        // Split only if the remainder exceeds this (-1 = default)
+    MemSize min_block_size;         // Smallest block handed out
+    MemSize alignment;              // Block size and address alignment
+    bool queue;                     // Queue failed requests instead of dropping them
+    QueuePolicy queue_policy;       // Which waiter is admitted first
+    bool replay;                    // Replay the input on its Arrival/Duration timeline
+    bool search;                    // Run the adversarial workload search
+    AllocationStrategy search_strategy; // Strategy the search attacks
+    SearchObjective search_objective;   // What the search maximizes
+    int search_generations;         // Generations to evolve
+    const char *search_output;      // Prefix of the written traces (NULL = worst_<strategy>)
+    int threads;                    // Evaluation threads (0 = one per core)
+    LifetimePolicy lifetime_policy; // Segregate long- and short-lived requests in replays
+    bool swap;                      // Swap processes out when a request finds no hole
+    SwapPolicy swap_policy;         // Which processes are swapped out
+} SimulationOptions;
+
+SimulationOptions sim_options = {NULL, NULL, 1, false, false, COALESCE_IMMEDIATE, COALESCE_THRESHOLD,
+                                 false, BATCH_ORDER_INPUT, false, false, REPLACE_LRU, 0, NULL,
+                                 0, true, NUMA_LOCAL_FIRST, NULL, 0,
+                                 -1, DEFAULT_MIN_BLOCK_SIZE, DEFAULT_ALIGNMENT,
+                                 false, QUEUE_FIFO, false, false, FIRST_FIT, SEARCH_FAILURES,
+                                 SEARCH_GENERATIONS, NULL, 0, LIFETIME_OFF, false, SWAP_OLDEST}; // Set from the command line
+
 /* Function prototypes */
 void initialize_memory_manager(MemoryManager *manager, AllocationStrategy strategy);
-int find_first_fit(MemoryManager *manager, int size);
-int find_best_fit(MemoryManager *manager, int size);
-int find_worst_fit(MemoryManager *manager, int size);
+void destroy_memory_manager(MemoryManager *manager);
+bool reserve_blocks(MemoryManager *manager, int count);
+void copy_blocks(MemoryManager *manager, const MemoryManager *source);
+const char *get_strategy_name(AllocationStrategy strategy);
+const char *get_unit_name(void);
+MemSize bytes_to_units(MemSize bytes);
+int find_first_fit(MemoryManager *manager, MemSize size);
+int find_best_fit(MemoryManager *manager, MemSize size);
+int find_worst_fit(MemoryManager *manager, MemSize size);
+int find_bitmap_fit(MemoryManager *manager, MemSize size);
+int find_block_containing(MemoryManager *manager, MemSize address);
+int find_block(MemoryManager *manager, MemSize size);
+int find_block_from_top(MemoryManager *manager, MemSize size);
+PageBitmap *bitmap_create(MemSize total_size);
+void bitmap_destroy(PageBitmap *bitmap);
+void bitmap_update_summary(PageBitmap *bitmap, int word);
+void bitmap_set_range(PageBitmap *bitmap, int first_page, int page_count, bool used);
+int bitmap_next_free(PageBitmap *bitmap, int page);
+int bitmap_next_used(PageBitmap *bitmap, int page);
+void bitmap_mark_block(MemoryManager *manager, int block_index, bool used);
 bool allocate_memory(MemoryManager *manager, Process *process);
+bool place_process(MemoryManager *manager, Process *process);
+MemSize round_request_size(MemoryManager *manager, MemSize size);
+void align_to_pages(MemoryManager *manager);
+bool should_split(MemoryManager *manager, MemSize block_size, MemSize request_size);
+int make_room_for_split(MemoryManager *manager, int block_index);
 void deallocate_memory(MemoryManager *manager, Process *process);
+void release_process(MemoryManager *manager, Process *process);
 bool coalesce_memory(MemoryManager *manager, Process processes[]); // New separate coalescing function
-bool read_processes_from_file(const char *filename, Process processes[], int *num_processes, int *memory_size);
+int coalesce_deferred_blocks(MemoryManager *manager);
+int take_reusable_block(MemoryManager *manager, MemSize size);
+const char *get_coalesce_policy_name(CoalescePolicy policy);
+bool read_processes_from_file(const char *filename, Process **processes, int *num_processes, MemSize *memory_size);
 void print_memory_state_simplified(MemoryManager *manager, Process processes[], int num_processes);
 void print_memory_state_detailed(MemoryManager *manager, Process processes[], int num_processes);
+void print_memory_map(MemoryManager *manager, int width);
 void update_fragmentation_metrics(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
+void record_utilization(MemoryManager *manager, Statistics *stats);
+int allocate_memory_batch(MemoryManager *manager, Process *requests[], int count, BatchOrder order, BatchReport *report);
+void allocate_requests(MemoryManager *manager, Process *requests[], int count, Statistics *stats);
+void print_batch_report(const BatchReport *report);
+MemSize largest_free_hole(MemoryManager *manager);
+PageBitmap *bitmap_clone(const PageBitmap *bitmap);
+void run_initial_allocation_phase(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
+void run_termination_phase(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
+void run_additional_allocation_phase(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
+void run_large_allocation_phase(MemoryManager *manager, Process processes[], int *num_processes, Statistics *stats);
+void print_final_results(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
+void run_remaining_phases(MemoryManager *manager, Process processes[], int *num_processes, Statistics *stats);
+void run_branches(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
 void run_simulation(MemoryManager *manager, AllocationStrategy strategy, Process processes[], int num_processes, Statistics *stats);
+void run_benchmark(void);
+SimulationSnapshot *snapshot_create(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
+SimulationSnapshot *snapshot_fork(SimulationSnapshot *snapshot);
+void snapshot_release(SimulationSnapshot *snapshot);
+bool snapshot_restore(const SimulationSnapshot *snapshot, MemoryManager *manager, Process processes[], int *num_processes, Statistics *stats);
+bool snapshot_append_to_file(const SimulationSnapshot *snapshot, const char *filename);
+SimulationSnapshot *snapshot_load(const char *filename, AllocationStrategy strategy);
+long long now_ns(void);
+void log_untimed(MemoryManager *manager, const char *format, ...);
+const char *get_manager_name(MemoryManager *manager);
+AdaptiveState *adaptive_create(MemoryManager *manager);
+void adaptive_destroy(AdaptiveState *adaptive);
+void adaptive_sync(MemoryManager *manager);
+void adaptive_record_allocation(MemoryManager *manager, Process *process);
+void adaptive_record_deallocation(MemoryManager *manager, Process *process);
+void adaptive_evaluate(MemoryManager *manager);
+void print_adaptive_report(MemoryManager *manager);
+LatencyRecorder *latency_create(void);
+void latency_destroy(LatencyRecorder *recorder);
+void latency_record(LatencyRecorder *recorder, OperationKind kind, long long nanoseconds);
+uint64_t latency_percentile(const LatencyHistogram *histogram, double percentile);
+void print_latency_report(const LatencyRecorder *recorder);
+void histogram_record(LatencyHistogram *histogram, uint64_t value);
+const char *get_queue_policy_name(QueuePolicy policy);
+AdmissionQueue *queue_create(QueuePolicy policy);
+void queue_destroy(AdmissionQueue *queue);
+void queue_enqueue(MemoryManager *manager, Process *process);
+void queue_reset(MemoryManager *manager, Process processes[], int num_processes);
+void queue_tick(AdmissionQueue *queue);
+int queue_pick(MemoryManager *manager, MemSize hole);
+bool admit_request(MemoryManager *manager, Process *process);
+MemSize largest_free_run(MemoryManager *manager, MemSize start, MemSize end);
+void queue_retry(MemoryManager *manager, MemSize freed_address);
+void print_queue_report(const AdmissionQueue *queue);
+int compare_replay_events(const void *a, const void *b);
+void replay_workload(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats);
+void print_replay_table(Process processes[], int num_processes);
+const char *get_search_strategy_key(AllocationStrategy strategy);
+void evaluate_candidate(SearchCandidate *candidate, AllocationStrategy strategy, SearchObjective objective);
+void search_pool_start(SearchPool *pool, int threads, AllocationStrategy strategy, SearchObjective objective);
+void search_pool_stop(SearchPool *pool);
+void *search_worker(void *arg);
+void evaluate_generation(SearchPool *pool, SearchCandidate candidates[], int count);
+void mutate_candidate(SearchCandidate *candidate, uint64_t *rng);
+void copy_candidate(SearchCandidate *target, const SearchCandidate *source);
+void crossover_candidates(const SearchCandidate *a, const SearchCandidate *b, SearchCandidate *child, uint64_t *rng);
+int compare_candidates(const void *a, const void *b);
+bool write_workload(const char *filename, const SearchCandidate *candidate, const char *comment);
+void run_adversarial_search(Process processes[], int num_processes);
+const char *get_lifetime_policy_name(LifetimePolicy policy);
+LifetimeModel *lifetime_create(LifetimePolicy policy);
+void lifetime_destroy(LifetimeModel *model);
+void lifetime_train(LifetimeModel *model, const Process processes[], int num_processes);
+bool is_long_lived(LifetimeModel *model, Process *process);
+const char *get_swap_policy_name(SwapPolicy policy);
+SwapSpace *swap_create(SwapPolicy policy);
+void swap_destroy(SwapSpace *swap);
+void swap_reset(MemoryManager *manager, Process processes[], int num_processes);
+void swap_index_rebuild(MemoryManager *manager);
+void swap_index_place(MemoryManager *manager, Process *process);
+void swap_index_release(MemoryManager *manager, Process *process);
+bool swap_out_for(MemoryManager *manager, Process *process, MemSize request_size);
+void swap_out_process(MemoryManager *manager, Process *victim);
+void swap_in_waiting(MemoryManager *manager);
+void swap_discard(MemoryManager *manager, Process *process);
+void print_swap_report(const SwapSpace *swap);
+const char *get_replacement_policy_name(ReplacementPolicy policy);
+PagingSystem *paging_create(MemoryManager *manager, Process processes[], int num_processes,
+                            ReplacementPolicy policy, int frame_count, MemSize page_size);
+void paging_destroy(PagingSystem *paging, MemoryManager *manager);
+void paging_reference(PagingSystem *paging, int32_t page);
+int32_t *load_reference_trace(const char *filename, PagingSystem *paging, size_t *count);
+int32_t *generate_reference_trace(PagingSystem *paging, size_t count, uint64_t seed);
+void print_paging_report(const PagingSystem *paging, double seconds);
+void run_paging_simulation(Process processes[], int num_processes);
+const char *get_numa_policy_name(NumaPolicy policy);
+void numa_init(NumaSystem *numa, int node_count, AllocationStrategy strategy, NumaPolicy policy);
+void numa_destroy(NumaSystem *numa);
+bool numa_load_distances(NumaSystem *numa, const char *filename);
+void numa_order_nodes(NumaSystem *numa);
+int numa_allocate(NumaSystem *numa, Process node_processes[][BENCH_SLOTS], int slot, const Process *request, int home);
+void numa_deallocate(NumaSystem *numa, Process node_processes[][BENCH_SLOTS], int slot, int node);
+void numa_sample(NumaSystem *numa);
+void print_numa_report(NumaSystem *numa, AllocationStrategy strategy, Statistics *stats);
+void run_numa_simulation(Process processes[], int num_processes);
 
 /*#####################################################################################################################*/
 // Implement the following 4 functions
@@ -121,7 +829,7 @@ void run_simulation(MemoryManager *manager, AllocationStrategy strategy, Process
  */
 
 
-int find_first_fit(MemoryManager *manager, int size)
+int find_first_fit(MemoryManager *manager, MemSize size)
 {
     // TO BE IMPLEMENTED BY STUDENTS
     /* Hint:
@@ -131,7 +839,7 @@ int find_first_fit(MemoryManager *manager, int size)
     */
     for (int i = 0; i < manager->block_count; i++)
         {
-            if (manager->blocks[i].is_free && manager->blocks[i].size >= size)
+            if (is_block_free(&manager->blocks[i]) && get_block_size(&manager->blocks[i]) >= size)
             {
                 return i;
             }
@@ -152,7 +860,7 @@ int find_first_fit(MemoryManager *manager, int size)
  * Returns:
  *   Index of the suitable block, or -1 if no suitable block was found
  */
-int find_best_fit(MemoryManager *manager, int size)
+int find_best_fit(MemoryManager *manager, MemSize size)
 {
     // TO BE IMPLEMENTED BY STUDENTS
     /* Hint:
@@ -161,13 +869,13 @@ int find_best_fit(MemoryManager *manager, int size)
        - Return its index or -1 if none is found
     */
     int best_index = -1;
-        int smallest_diff = INT_MAX;
+        MemSize smallest_diff = LLONG_MAX;
 
         for (int i = 0; i < manager->block_count; i++)
         {
-            if (manager->blocks[i].is_free && manager->blocks[i].size >= size)
+            if (is_block_free(&manager->blocks[i]) && get_block_size(&manager->blocks[i]) >= size)
             {
-                int diff = manager->blocks[i].size - size;
+                MemSize diff = get_block_size(&manager->blocks[i]) - size;
                 if (diff < smallest_diff)
                 {
                     smallest_diff = diff;
@@ -192,7 +900,7 @@ int find_best_fit(MemoryManager *manager, int size)
  * Returns:
  *   Index of the suitable block, or -1 if no suitable block was found
  */
-int find_worst_fit(MemoryManager *manager, int size)
+int find_worst_fit(MemoryManager *manager, MemSize size)
 {
     // TO BE IMPLEMENTED BY STUDENTS
     /* Hint:
@@ -201,13 +909,13 @@ int find_worst_fit(MemoryManager *manager, int size)
        - Return its index or -1 if none is found
     */
     int worst_index = -1;
-        int largest_diff = -1;
+        MemSize largest_diff = -1;
 
         for (int i = 0; i < manager->block_count; i++)
         {
-            if (manager->blocks[i].is_free && manager->blocks[i].size >= size)
+            if (is_block_free(&manager->blocks[i]) && get_block_size(&manager->blocks[i]) >= size)
             {
-                int diff = manager->blocks[i].size - size;
+                MemSize diff = get_block_size(&manager->blocks[i]) - size;
                 if (diff > largest_diff)
                 {
                     largest_diff = diff;
@@ -248,16 +956,25 @@ bool coalesce_memory(MemoryManager *manager, Process processes[])
             MemoryBlock *curr = &manager->blocks[i];
             MemoryBlock *next = &manager->blocks[i + 1];
 
-            if (curr->is_free && next->is_free)
+            if (is_block_free(curr) && is_block_free(next))
             {
-                curr->size += next->size;
+                set_block_size(curr, get_block_size(curr) + get_block_size(next));
 
                 for (int j = i + 1; j < manager->block_count - 1; j++)
                 {
                     manager->blocks[j] = manager->blocks[j + 1];
                 }
 
+                for (int j = 0; j < manager->process_count; j++)
+                {
+                    if (processes[j].block_index > i + 1)
+                    {
+                        processes[j].block_index--;
+                    }
+                }
+
                 manager->block_count--;
+                manager->merge_count++;
                 merged = true;
                 // Don't increment i, check the new next block again
             }
@@ -276,20 +993,235 @@ bool coalesce_memory(MemoryManager *manager, Process processes[])
 int main(int argc, char *argv[])
 {
     char input_file[256] = DEFAULT_INPUT_FILE;
+    bool benchmark = false;
 
     // Parse command line arguments
-    if (argc > 1)
-        strcpy(input_file, argv[1]);
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--benchmark") == 0)
+        {
+            benchmark = true;
+        }
+        else if (strcmp(argv[i], "--latency") == 0)
+        {
+            sim_options.latency = true;
+        }
+        else if (strcmp(argv[i], "--coalesce") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.coalesce_policy = (strcmp(argv[i], "deferred") == 0) ? COALESCE_DEFERRED : COALESCE_IMMEDIATE;
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.batch = true;
+            sim_options.batch_order = (strcmp(argv[i], "decreasing") == 0) ? BATCH_ORDER_DECREASING : BATCH_ORDER_INPUT;
+        }
+        else if (strcmp(argv[i], "--coalesce-threshold") == 0 && i + 1 < argc)
+        {
+            sim_options.coalesce_threshold = atoi(argv[++i]);
+            if (sim_options.coalesce_threshold < 1)
+                sim_options.coalesce_threshold = 1;
+        }
+        else if (strcmp(argv[i], "--save-snapshot") == 0 && i + 1 < argc)
+        {
+            sim_options.save_snapshot_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--load-snapshot") == 0 && i + 1 < argc)
+        {
+            sim_options.load_snapshot_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--paging") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.paging = true;
+            sim_options.paging_compare_all = strcmp(argv[i], "all") == 0;
+            if (strcmp(argv[i], "clock") == 0)
+                sim_options.paging_policy = REPLACE_CLOCK;
+            else if (strcmp(argv[i], "arc") == 0)
+                sim_options.paging_policy = REPLACE_ARC;
+            else
+                sim_options.paging_policy = REPLACE_LRU;
+        }
+        else if (strcmp(argv[i], "--numa") == 0 && i + 1 < argc)
+        {
+            sim_options.numa_nodes = atoi(argv[++i]);
+            if (sim_options.numa_nodes < 1)
+                sim_options.numa_nodes = 1;
+            if (sim_options.numa_nodes > MAX_NUMA_NODES)
+                sim_options.numa_nodes = MAX_NUMA_NODES;
+        }
+        else if (strcmp(argv[i], "--numa-policy") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.numa_compare_all = strcmp(argv[i], "all") == 0;
+            if (strcmp(argv[i], "interleave") == 0)
+                sim_options.numa_policy = NUMA_INTERLEAVE;
+            else if (strcmp(argv[i], "spill") == 0)
+                sim_options.numa_policy = NUMA_SPILL_OVER;
+            else
+                sim_options.numa_policy = NUMA_LOCAL_FIRST;
+        }
+        else if (strcmp(argv[i], "--numa-distance") == 0 && i + 1 < argc)
+        {
+            sim_options.numa_distance_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.queue = true;
+            if (strcmp(argv[i], "smallest") == 0)
+                sim_options.queue_policy = QUEUE_SMALLEST_FIRST;
+            else if (strcmp(argv[i], "best-fit") == 0)
+                sim_options.queue_policy = QUEUE_BEST_FIT;
+            else
+                sim_options.queue_policy = QUEUE_FIFO;
+        }
+        else if (strcmp(argv[i], "--replay") == 0)
+        {
+            sim_options.replay = true;
+        }
+        else if (strcmp(argv[i], "--search") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.search = true;
+            if (strcmp(argv[i], "best") == 0)
+                sim_options.search_strategy = BEST_FIT;
+            else if (strcmp(argv[i], "worst") == 0)
+                sim_options.search_strategy = WORST_FIT;
+            else if (strcmp(argv[i], "bitmap") == 0)
+                sim_options.search_strategy = BITMAP_FIT;
+            else
+                sim_options.search_strategy = FIRST_FIT;
+        }
+        else if (strcmp(argv[i], "--search-objective") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.search_objective = (strcmp(argv[i], "fragmentation") == 0) ? SEARCH_FRAGMENTATION : SEARCH_FAILURES;
+        }
+        else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc)
+        {
+            sim_options.search_generations = atoi(argv[++i]);
+            if (sim_options.search_generations < 0)
+                sim_options.search_generations = 0;
+        }
+        else if (strcmp(argv[i], "--search-output") == 0 && i + 1 < argc)
+        {
+            sim_options.search_output = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            sim_options.threads = atoi(argv[++i]);
+            if (sim_options.threads < 0)
+                sim_options.threads = 0;
+        }
+        else if (strcmp(argv[i], "--swap") == 0 && i + 1 < argc)
+        {
+            i++;
+            sim_options.swap = true;
+            if (strcmp(argv[i], "largest") == 0)
+                sim_options.swap_policy = SWAP_LARGEST_FIRST;
+            else if (strcmp(argv[i], "min-bytes") == 0)
+                sim_options.swap_policy = SWAP_MIN_BYTES;
+            else
+                sim_options.swap_policy = SWAP_OLDEST;
+        }
+        else if (strcmp(argv[i], "--lifetime") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (strcmp(argv[i], "oracle") == 0)
+                sim_options.lifetime_policy = LIFETIME_ORACLE;
+            else if (strcmp(argv[i], "predict") == 0)
+                sim_options.lifetime_policy = LIFETIME_PREDICTED;
+            else
+                sim_options.lifetime_policy = LIFETIME_OFF;
+        }
+        else if (strcmp(argv[i], "--split-threshold") == 0 && i + 1 < argc)
+        {
+            sim_options.split_threshold = atoll(argv[++i]);
+            if (sim_options.split_threshold < 0)
+                sim_options.split_threshold = 0;
+        }
+        else if (strcmp(argv[i], "--min-block") == 0 && i + 1 < argc)
+        {
+            sim_options.min_block_size = atoll(argv[++i]);
+            if (sim_options.min_block_size < 1)
+                sim_options.min_block_size = 1;
+        }
+        else if (strcmp(argv[i], "--alignment") == 0 && i + 1 < argc)
+        {
+            sim_options.alignment = atoll(argv[++i]);
+            if (sim_options.alignment < 1)
+                sim_options.alignment = 1;
+        }
+        else if (strcmp(argv[i], "--memory-map") == 0 && i + 1 < argc)
+        {
+            sim_options.map_interval = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            sim_options.frame_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            sim_options.trace_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--unit") == 0 && i + 1 < argc)
+        {
+            allocation_unit = atoi(argv[++i]);
+            if (allocation_unit < 1)
+                allocation_unit = 1;
+        }
+        else if (strcmp(argv[i], "--adaptive") == 0)
+        {
+            sim_options.adaptive = true;
+        }
+        else if (strcmp(argv[i], "--branches") == 0 && i + 1 < argc)
+        {
+            sim_options.branch_count = atoi(argv[++i]);
+            if (sim_options.branch_count < 1)
+                sim_options.branch_count = 1;
+            if (sim_options.branch_count > MAX_BRANCHES)
+                sim_options.branch_count = MAX_BRANCHES;
+        }
+        else
+        {
+            strcpy(input_file, argv[i]);
+        }
+    }
+
+    // The default split threshold is in bytes, so it depends on --unit
+    if (sim_options.split_threshold < 0)
+    {
+        sim_options.split_threshold = bytes_to_units(DEFAULT_SPLIT_THRESHOLD_BYTES);
+    }
+
+    if (benchmark)
+    {
+        run_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    // Start a fresh snapshot file; each strategy appends its own record
+    if (sim_options.save_snapshot_file != NULL)
+    {
+        FILE *snapshot_file = fopen(sim_options.save_snapshot_file, "wb");
+        if (snapshot_file == NULL)
+        {
+            fprintf(stderr, "Error: Could not create snapshot file '%s'\n", sim_options.save_snapshot_file);
+            return EXIT_FAILURE;
+        }
+        fclose(snapshot_file);
+    }
 
     // Initialize random seed
     srand(time(NULL));
 
     // Load processes from input file
-    Process processes[MAX_PROCESSES];
+    Process *processes = NULL;
     int num_processes = 0;
-    int memory_size = 0;
 
-    if (!read_processes_from_file(input_file, processes, &num_processes, &memory_size))
+    if (!read_processes_from_file(input_file, &processes, &num_processes, &memory_size))
     {
         fprintf(stderr, "Failed to read processes from input file.\n");
         return EXIT_FAILURE;
@@ -297,53 +1229,92 @@ int main(int argc, char *argv[])
 
     printf("\n===== STATIC MEMORY ALLOCATION SIMULATION =====\n\n");
     printf("Input file: %s\n", input_file);
-    printf("Memory size: %d KB\n", memory_size);
+    printf("Memory size: %lld %s\n", memory_size, get_unit_name());
     printf("Number of processes: %d\n\n", num_processes);
 
     // Print process info before simulation
     printf("-------------------------------------------------\n");
     printf("Processes Loaded:\n");
-    printf("%-10s %-10s\n", "ProcessID", "Size (KB)");
+    char size_header[32];
+    snprintf(size_header, sizeof(size_header), "Size (%s)", get_unit_name());
+    printf("%-10s %-10s\n", "ProcessID", size_header);
     printf("-------------------------------------------------\n");
     for (int i = 0; i < num_processes; i++)
     {
-        printf("%-10d %-10d\n", processes[i].id, processes[i].size);
+        printf("%-10d %-10lld\n", processes[i].id, processes[i].size);
     }
     printf("\n");
 
-    // Initialize statistics for each strategy
-    Statistics stats[3] = {0};
-    AllocationStrategy strategies[3] = {FIRST_FIT, BEST_FIT, WORST_FIT};
+    if (sim_options.paging)
+    {
+        run_paging_simulation(processes, num_processes);
+        free(processes);
+        return EXIT_SUCCESS;
+    }
+    if (sim_options.numa_nodes > 0)
+    {
+        run_numa_simulation(processes, num_processes);
+        free(processes);
+        return EXIT_SUCCESS;
+    }
+    if (sim_options.search)
+    {
+        run_adversarial_search(processes, num_processes);
+        free(processes);
+        return EXIT_SUCCESS;
+    }
+    if (sim_options.replay)
+    {
+        print_replay_table(processes, num_processes);
+        free(processes);
+        return EXIT_SUCCESS;
+    }
+
+    // Initialize statistics for each strategy (plus the optional adaptive run,
+    // which starts out as First Fit)
+    Statistics stats[NUM_STRATEGIES + 1] = {0};
+    AllocationStrategy strategies[NUM_STRATEGIES + 1] = {FIRST_FIT, BEST_FIT, WORST_FIT, BITMAP_FIT, FIRST_FIT};
+    int num_runs = sim_options.adaptive ? NUM_STRATEGIES + 1 : NUM_STRATEGIES;
 
     // Run simulations for each allocation strategy
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < num_runs; i++)
     {
         MemoryManager manager;
         initialize_memory_manager(&manager, strategies[i]);
 
-        // Set the correct memory size from the input file
-        manager.total_size = memory_size;
-        manager.free_size = memory_size;
-        manager.blocks[0].size = memory_size;
-
         // Make a copy of processes for each simulation
-        Process simulation_processes[MAX_PROCESSES];
+        // (one spare slot for the large process added in phase 4)
+        Process *simulation_processes = malloc(sizeof(Process) * ((size_t)num_processes + 1));
+        if (simulation_processes == NULL)
+        {
+            fprintf(stderr, "Error: Could not allocate process table\n");
+            exit(EXIT_FAILURE);
+        }
         memcpy(simulation_processes, processes, sizeof(Process) * num_processes);
 
+        if (i == NUM_STRATEGIES)
+        {
+            manager.process_table = simulation_processes;
+            manager.process_count = num_processes;
+            adaptive_create(&manager);
+        }
+
         run_simulation(&manager, strategies[i], simulation_processes, num_processes, &stats[i]);
+        destroy_memory_manager(&manager);
+        free(simulation_processes);
     }
 
     /**
      * Print simplified summary table
      */
     printf("\n=== Summary of Allocation Methods ===\n");
-    printf("%-10s %-15s %-15s %-15s\n", "Strategy", "Success Rate", "Fragmentation", "Block Count");
-    printf("----------------------------------------------------------\n");
+    printf("%-10s %-15s %-15s %-15s %-15s\n", "Strategy", "Success Rate", "Fragmentation", "Block Count", "Internal Frag");
+    printf("--------------------------------------------------------------------------\n");
 
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < num_runs; i++)
     {
         char *strategy_name;
-        switch (strategies[i])
+        switch (i == NUM_STRATEGIES ? -1 : (int)strategies[i])
         {
         case FIRST_FIT:
             strategy_name = "First Fit";
@@ -354,6 +1325,12 @@ int main(int argc, char *argv[])
         case WORST_FIT:
             strategy_name = "Worst Fit";
             break;
+        case BITMAP_FIT:
+            strategy_name = "Bitmap Fit";
+            break;
+        case -1:
+            strategy_name = "Adaptive";
+            break;
         default:
             strategy_name = "Unknown";
             break;
@@ -363,17 +1340,21 @@ int main(int argc, char *argv[])
             (stats[i].allocation_attempts > 0) ? ((double)stats[i].successful_allocations / stats[i].allocation_attempts * 100.0) : 0.0;
 
         // Create formatted strings with percentages
-        char success_str[20], frag_str[20];
+        char success_str[20], frag_str[20], internal_str[20];
         sprintf(success_str, "%.1f%%", success_rate);
         sprintf(frag_str, "%.1f%%", stats[i].fragmentation_percentage);
+        snprintf(internal_str, sizeof(internal_str), "%lld %s", stats[i].internal_fragmentation, get_unit_name());
 
         // Print with strings that already include the percent symbol
-        printf("%-10s %-15s %-15s %-15d\n",
+        printf("%-10s %-15s %-15s %-15d %-15s\n",
                strategy_name,
                success_str,
                frag_str,
-               stats[i].external_fragmentation);
+               stats[i].external_fragmentation,
+               internal_str);
     }
+
+    free(processes);
 }
 
 /**
@@ -384,54 +1365,376 @@ void initialize_memory_manager(MemoryManager *manager, AllocationStrategy strate
     manager->total_size = memory_size;
     manager->free_size = manager->total_size;
     manager->block_count = 1;
+    manager->block_capacity = 0;
+    manager->blocks = NULL;
+    if (!reserve_blocks(manager, INITIAL_BLOCK_CAPACITY))
+    {
+        fprintf(stderr, "Error: Could not allocate block array\n");
+        exit(EXIT_FAILURE);
+    }
     manager->strategy = strategy;
+    manager->internal_fragmentation = 0;
+    manager->padding_fragmentation = 0;
+    manager->slack_fragmentation = 0;
+    manager->split_threshold = sim_options.split_threshold;
+    manager->min_block_size = sim_options.min_block_size;
+    manager->bitmap = NULL;
+    manager->process_table = NULL;
+    manager->process_count = 0;
+    manager->verbose = true;
+    manager->adaptive = NULL;
+    manager->latency = sim_options.latency ? latency_create() : NULL;
+    manager->queue = sim_options.queue ? queue_create(sim_options.queue_policy) : NULL;
+    manager->lifetime = sim_options.lifetime_policy != LIFETIME_OFF ? lifetime_create(sim_options.lifetime_policy) : NULL;
+    manager->swap = sim_options.swap ? swap_create(sim_options.swap_policy) : NULL;
+    manager->coalesce_policy = sim_options.coalesce_policy;
+    manager->coalesce_threshold = sim_options.coalesce_threshold;
+    manager->pending_frees = 0;
+    manager->reuse_count = 0;
+    manager->merge_count = 0;
+    manager->deferred_merges = 0;
+    manager->quick_reuse_hits = 0;
+    manager->untimed_ns = 0;
 
     // Create initial free block covering all memory
     manager->blocks[0].start_address = 0;
-    manager->blocks[0].size = manager->total_size;
-    manager->blocks[0].is_free = true;
-    manager->blocks[0].process_id = -1;
+    set_block(&manager->blocks[0], manager->total_size, true);
+    if (manager->swap != NULL)
+    {
+        swap_index_rebuild(manager);
+    }
+
+    if (strategy == BITMAP_FIT)
+    {
+        manager->bitmap = bitmap_create(manager->total_size);
+    }
+    align_to_pages(manager);
 }
 
 /**
- * Allocate memory for a process using the selected strategy
+ * Release resources owned by the memory manager
  */
-bool allocate_memory(MemoryManager *manager, Process *process)
+void destroy_memory_manager(MemoryManager *manager)
+{
+    free(manager->blocks);
+    manager->blocks = NULL;
+    manager->block_capacity = 0;
+    bitmap_destroy(manager->bitmap);
+    manager->bitmap = NULL;
+    adaptive_destroy(manager->adaptive);
+    manager->adaptive = NULL;
+    latency_destroy(manager->latency);
+    manager->latency = NULL;
+    queue_destroy(manager->queue);
+    manager->queue = NULL;
+    lifetime_destroy(manager->lifetime);
+    manager->lifetime = NULL;
+    swap_destroy(manager->swap);
+    manager->swap = NULL;
+}
+
+/**
+ * Make room for at least count blocks, doubling the block array as needed
+ *
+ * Returns:
+ *   true on success, false if the array could not be grown
+ */
+bool reserve_blocks(MemoryManager *manager, int count)
 {
-    // Check if enough total memory is available
-    if (process->size > manager->free_size)
+    if (count <= manager->block_capacity)
     {
-        return false;
+        return true;
     }
 
-    // Find a suitable block based on the allocation strategy
-    int block_index = -1;
-
-    switch (manager->strategy)
+    int capacity = manager->block_capacity > 0 ? manager->block_capacity : INITIAL_BLOCK_CAPACITY;
+    while (capacity < count)
     {
-    case FIRST_FIT:
-        block_index = find_first_fit(manager, process->size);
-        break;
-    case BEST_FIT:
-        block_index = find_best_fit(manager, process->size);
-        break;
-    case WORST_FIT:
-        block_index = find_worst_fit(manager, process->size);
-        break;
+        capacity = capacity > INT_MAX / 2 ? INT_MAX : capacity * 2;
     }
 
-    if (block_index == -1)
+    MemoryBlock *blocks = realloc(manager->blocks, sizeof(MemoryBlock) * (size_t)capacity);
+    if (blocks == NULL)
     {
-        return false; // No suitable block found
+        return false;
     }
+    manager->blocks = blocks;
+    manager->block_capacity = capacity;
+    return true;
+}
 
-    // If the block is larger than needed, split it
-    // Only split if the remaining size would be at least 10KB
-    if (manager->blocks[block_index].size > process->size + 10)
+/**
+ * Replace a manager's blocks with a copy of another manager's
+ */
+void copy_blocks(MemoryManager *manager, const MemoryManager *source)
+{
+    if (!reserve_blocks(manager, source->block_count))
     {
-        if (manager->block_count >= MAX_BLOCKS)
+        fprintf(stderr, "Error: Could not allocate block array\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(manager->blocks, source->blocks, sizeof(MemoryBlock) * (size_t)source->block_count);
+    manager->block_count = source->block_count;
+}
+
+/**
+ * Get the display name of a simulation (its strategy, or "Adaptive")
+ */
+const char *get_manager_name(MemoryManager *manager)
+{
+    return manager->adaptive != NULL ? "Adaptive" : get_strategy_name(manager->strategy);
+}
+
+/**
+ * Get the display name of an allocation strategy
+ */
+const char *get_strategy_name(AllocationStrategy strategy)
+{
+    switch (strategy)
+    {
+    case FIRST_FIT:
+        return "First-Fit";
+    case BEST_FIT:
+        return "Best-Fit";
+    case WORST_FIT:
+        return "Worst-Fit";
+    case BITMAP_FIT:
+        return "Bitmap-Fit";
+    }
+    return "Unknown";
+}
+
+/**
+ * Get the display name of the allocation unit ("KB" by default)
+ */
+const char *get_unit_name(void)
+{
+    switch (allocation_unit)
+    {
+    case 1:
+        return "B";
+    case 1024:
+        return "KB";
+    case 1024 * 1024:
+        return "MB";
+    case 1024 * 1024 * 1024:
+        return "GB";
+    }
+    return "units";
+}
+
+/**
+ * Convert a size in bytes to allocation units, rounding up to at least one
+ */
+MemSize bytes_to_units(MemSize bytes)
+{
+    MemSize units = (bytes + allocation_unit - 1) / allocation_unit;
+    return units > 0 ? units : 1;
+}
+
+/**
+ * Allocate memory for a process using the selected strategy
+ */
+bool allocate_memory(MemoryManager *manager, Process *process)
+{
+    if (manager->adaptive == NULL && manager->latency == NULL)
+    {
+        return place_process(manager, process);
+    }
+
+    long long start = now_ns();
+    long long untimed = manager->untimed_ns;
+    bool allocated = place_process(manager, process);
+    long long elapsed = now_ns() - start - (manager->untimed_ns - untimed);
+
+    if (manager->latency != NULL)
+    {
+        latency_record(manager->latency, OP_ALLOCATE, elapsed);
+    }
+    if (manager->adaptive != NULL)
+    {
+        manager->adaptive->primary_ns += elapsed;
+        adaptive_record_allocation(manager, process);
+    }
+    return allocated;
+}
+
+/**
+ * Find a free block for the given size with the manager's current strategy
+ */
+int find_block(MemoryManager *manager, MemSize size)
+{
+    int block_index = -1;
+    long long start = (manager->latency != NULL) ? now_ns() : 0;
+
+    switch (manager->strategy)
+    {
+    case FIRST_FIT:
+        block_index = find_first_fit(manager, size);
+        break;
+    case BEST_FIT:
+        block_index = find_best_fit(manager, size);
+        break;
+    case WORST_FIT:
+        block_index = find_worst_fit(manager, size);
+        break;
+    case BITMAP_FIT:
+        block_index = find_bitmap_fit(manager, size);
+        break;
+    }
+
+    if (manager->latency != NULL)
+    {
+        latency_record(manager->latency, OP_FIND, now_ns() - start);
+    }
+    return block_index;
+}
+
+/**
+ * Find a free block for a long-lived request, searching down from the top
+ *
+ * Mirrors the block-list fits: First Fit takes the highest hole that fits,
+ * Best and Worst Fit break ties towards higher addresses.
+ */
+int find_block_from_top(MemoryManager *manager, MemSize size)
+{
+    int block_index = -1;
+    long long start = (manager->latency != NULL) ? now_ns() : 0;
+
+    for (int i = manager->block_count - 1; i >= 0; i--)
+    {
+        if (!is_block_free(&manager->blocks[i]) || get_block_size(&manager->blocks[i]) < size)
         {
-            return false;
+            continue;
+        }
+        if (block_index == -1 ||
+            (manager->strategy == BEST_FIT && get_block_size(&manager->blocks[i]) < get_block_size(&manager->blocks[block_index])) ||
+            (manager->strategy == WORST_FIT && get_block_size(&manager->blocks[i]) > get_block_size(&manager->blocks[block_index])))
+        {
+            block_index = i;
+        }
+        if (manager->strategy == FIRST_FIT)
+        {
+            break;
+        }
+    }
+
+    if (manager->latency != NULL)
+    {
+        latency_record(manager->latency, OP_FIND, now_ns() - start);
+    }
+    return block_index;
+}
+
+/**
+ * Place a process in a free block chosen by the current strategy
+ *
+ * With lifetime segregation, long-lived requests are placed from the top of
+ * memory down and everything else from the bottom up, so blocks freed
+ * together tend to sit next to each other.
+ */
+bool place_process(MemoryManager *manager, Process *process)
+{
+    MemSize request_size = round_request_size(manager, process->size);
+
+    // Bitmap Fit's page search has no top-down variant, so it never segregates
+    bool from_top = manager->lifetime != NULL && manager->strategy != BITMAP_FIT &&
+                    is_long_lived(manager->lifetime, process);
+
+    // Check if enough total memory is available; swapping may still free enough
+    bool may_swap = manager->swap != NULL && !manager->swap->swapping_in;
+    if (request_size > manager->free_size && !may_swap)
+    {
+        return false;
+    }
+
+    // Find a suitable block based on the allocation strategy. With deferred
+    // coalescing, a recently freed block of the right size is tried first, and
+    // pending frees are merged before giving up.
+    int block_index = -1;
+
+    if (manager->coalesce_policy == COALESCE_DEFERRED && !from_top)
+    {
+        block_index = take_reusable_block(manager, request_size);
+    }
+    if (block_index == -1)
+    {
+        block_index = from_top ? find_block_from_top(manager, request_size) : find_block(manager, request_size);
+    }
+    if (block_index == -1 && manager->coalesce_policy == COALESCE_DEFERRED &&
+        coalesce_deferred_blocks(manager) > 0)
+    {
+        block_index = from_top ? find_block_from_top(manager, request_size) : find_block(manager, request_size);
+    }
+    if (block_index == -1 && may_swap && swap_out_for(manager, process, request_size))
+    {
+        block_index = from_top ? find_block_from_top(manager, request_size) : find_block(manager, request_size);
+        if (block_index != -1)
+            manager->swap->rescued++;
+    }
+
+    if (block_index == -1)
+    {
+        return false; // No suitable block found
+    }
+
+    if (from_top)
+    {
+        // Carve the block from the end of the hole. Hole starts are aligned, so
+        // rounding the start down keeps it inside the hole; the tail it leaves
+        // (only at the very top of an unaligned pool) stays with the process.
+        MemoryBlock *hole = &manager->blocks[block_index];
+        MemSize hole_end = hole->start_address + get_block_size(hole);
+        MemSize start = hole_end - request_size;
+        start -= start % manager->alignment;
+
+        if (should_split(manager, get_block_size(hole), hole_end - start))
+        {
+            if (!reserve_blocks(manager, manager->block_count + 1))
+            {
+                // Merging may grow the hole upwards, so carve from its new end
+                block_index = make_room_for_split(manager, block_index);
+                if (block_index == -1)
+                {
+                    return false;
+                }
+                hole = &manager->blocks[block_index];
+                hole_end = hole->start_address + get_block_size(hole);
+                start = hole_end - request_size;
+                start -= start % manager->alignment;
+            }
+
+            for (int i = manager->block_count; i > block_index + 1; i--)
+            {
+                manager->blocks[i] = manager->blocks[i - 1];
+            }
+
+            // The free remainder keeps the lower part, the new block takes the top
+            manager->blocks[block_index + 1].start_address = start;
+            set_block(&manager->blocks[block_index + 1], hole_end - start, true);
+            set_block_size(&manager->blocks[block_index], start - manager->blocks[block_index].start_address);
+            manager->block_count++;
+
+            for (int j = 0; j < manager->process_count; j++)
+            {
+                if (manager->process_table[j].block_index > block_index)
+                {
+                    manager->process_table[j].block_index++;
+                }
+            }
+            block_index++;
+        }
+    }
+    // If the block is larger than needed, split it
+    // Only split if the remainder is over the split threshold and a valid block
+    else if (should_split(manager, get_block_size(&manager->blocks[block_index]), request_size))
+    {
+        if (!reserve_blocks(manager, manager->block_count + 1))
+        {
+            block_index = make_room_for_split(manager, block_index);
+            if (block_index == -1)
+            {
+                return false;
+            }
         }
 
         // Shift blocks to make space for new one
@@ -442,33 +1745,161 @@ bool allocate_memory(MemoryManager *manager, Process *process)
 
         // Create new free block with remaining space
         manager->blocks[block_index + 1].start_address =
-            manager->blocks[block_index].start_address + process->size;
-        manager->blocks[block_index + 1].size =
-            manager->blocks[block_index].size - process->size;
-        manager->blocks[block_index + 1].is_free = true;
-        manager->blocks[block_index + 1].process_id = -1;
+            manager->blocks[block_index].start_address + request_size;
+        set_block(&manager->blocks[block_index + 1], get_block_size(&manager->blocks[block_index]) - request_size, true);
 
         // Resize the original block
-        manager->blocks[block_index].size = process->size;
+        set_block_size(&manager->blocks[block_index], request_size);
 
         // Increment block count
         manager->block_count++;
+
+        // Blocks after the split moved up by one
+        for (int j = 0; j < manager->process_count; j++)
+        {
+            if (manager->process_table[j].block_index > block_index)
+            {
+                manager->process_table[j].block_index++;
+            }
+        }
     }
 
-    // Allocate the block to the process
-    manager->blocks[block_index].is_free = false;
-    manager->blocks[block_index].process_id = process->id;
+    // Allocate the block to the process; any unsplit remainder stays with it
+    set_block_free(&manager->blocks[block_index], false);
     process->block_index = block_index;
     process->state = PROCESS_RUNNING;
-    manager->free_size -= process->size;
+    manager->free_size -= get_block_size(&manager->blocks[block_index]);
+    manager->internal_fragmentation += get_block_size(&manager->blocks[block_index]) - process->size;
+    manager->padding_fragmentation += request_size - process->size;
+    manager->slack_fragmentation += get_block_size(&manager->blocks[block_index]) - request_size;
+    bitmap_mark_block(manager, block_index, true);
+    if (manager->swap != NULL)
+    {
+        swap_index_place(manager, process);
+    }
 
     return true;
 }
 
+/**
+ * Set the manager's alignment from --alignment and its page size
+ *
+ * Bitmap Fit tracks whole pages, so two blocks must never share one. Under
+ * Bitmap Fit the alignment is therefore raised to the least common multiple
+ * of --alignment and the page size; otherwise --alignment is used as given.
+ */
+void align_to_pages(MemoryManager *manager)
+{
+    manager->alignment = sim_options.alignment;
+    if (manager->bitmap == NULL)
+    {
+        return;
+    }
+
+    MemSize a = manager->alignment, b = manager->bitmap->page_size;
+    while (b != 0)
+    {
+        MemSize r = a % b;
+        a = b;
+        b = r;
+    }
+    manager->alignment = manager->alignment / a * manager->bitmap->page_size;
+}
+
+/**
+ * Size of the block a request needs
+ *
+ * The request is raised to the minimum block size, rounded up to whole pages
+ * for Bitmap Fit, then rounded up to the alignment. Since every block handed
+ * out or split off is a multiple of the alignment, block start addresses stay
+ * aligned too. Under Bitmap Fit the alignment is a multiple of the page size
+ * (see align_to_pages), so blocks also end on page boundaries.
+ */
+MemSize round_request_size(MemoryManager *manager, MemSize size)
+{
+    MemSize rounded = size < manager->min_block_size ? manager->min_block_size : size;
+
+    // Bitmap Fit hands out whole pages
+    if (manager->strategy == BITMAP_FIT && manager->bitmap != NULL)
+    {
+        MemSize page_size = manager->bitmap->page_size;
+        rounded = ((rounded + page_size - 1) / page_size) * page_size;
+    }
+
+    return ((rounded + manager->alignment - 1) / manager->alignment) * manager->alignment;
+}
+
+/**
+ * Whether a block should be split for a request, or handed out whole
+ *
+ * The remainder must exceed the split threshold and be at least the minimum
+ * block size; otherwise it stays with the process as unsplit slack.
+ */
+bool should_split(MemoryManager *manager, MemSize block_size, MemSize request_size)
+{
+    MemSize remainder = block_size - request_size;
+    return remainder > manager->split_threshold && remainder >= manager->min_block_size;
+}
+
 /**
  * Deallocate memory for a process and coalesce adjacent free blocks
  */
 void deallocate_memory(MemoryManager *manager, Process *process)
+{
+    // A process that ends while swapped out only leaves the backing store
+    if (process->state == PROCESS_SWAPPED && manager->swap != NULL)
+    {
+        swap_discard(manager, process);
+        return;
+    }
+
+    // Waiters are retried against the hole this block leaves
+    MemSize freed_address = process->block_index != -1 ? manager->blocks[process->block_index].start_address : -1;
+
+    if (process->block_index == -1 || (manager->adaptive == NULL && manager->latency == NULL))
+    {
+        release_process(manager, process);
+    }
+    else
+    {
+        if (manager->adaptive != NULL)
+        {
+            adaptive_record_deallocation(manager, process);
+        }
+
+        long long start = now_ns();
+        long long untimed = manager->untimed_ns;
+        release_process(manager, process);
+        long long elapsed = now_ns() - start - (manager->untimed_ns - untimed);
+
+        if (manager->latency != NULL)
+        {
+            latency_record(manager->latency, OP_DEALLOCATE, elapsed);
+        }
+        if (manager->adaptive != NULL)
+        {
+            manager->adaptive->primary_ns += elapsed;
+        }
+    }
+
+    if (manager->queue != NULL)
+    {
+        queue_tick(manager->queue);
+        if (freed_address >= 0 && manager->queue->count > 0)
+        {
+            queue_retry(manager, freed_address);
+        }
+    }
+    if (manager->swap != NULL && freed_address >= 0 && manager->swap->count > 0)
+    {
+        swap_in_waiting(manager);
+    }
+}
+
+/**
+ * Free a process's block and merge it with free neighbours
+ */
+void release_process(MemoryManager *manager, Process *process)
 {
     // If the process has no memory block assigned, exit early
     if (process->block_index == -1)
@@ -479,19 +1910,53 @@ void deallocate_memory(MemoryManager *manager, Process *process)
     int index = process->block_index;
 
     // Mark the memory block as free
-    manager->blocks[index].is_free = true;
-    manager->blocks[index].process_id = -1;
-    manager->free_size += manager->blocks[index].size;
+    set_block_free(&manager->blocks[index], true);
+    manager->free_size += get_block_size(&manager->blocks[index]);
+    MemSize padding = round_request_size(manager, process->size) - process->size;
+    manager->internal_fragmentation -= get_block_size(&manager->blocks[index]) - process->size;
+    manager->padding_fragmentation -= padding;
+    manager->slack_fragmentation -= get_block_size(&manager->blocks[index]) - process->size - padding;
+    bitmap_mark_block(manager, index, false);
+    if (manager->swap != NULL)
+    {
+        swap_index_release(manager, process);
+    }
 
     // Mark the process as terminated
     process->state = PROCESS_TERMINATED;
     process->block_index = -1;
 
+    // Deferred coalescing: keep the block as-is for quick reuse
+    if (manager->coalesce_policy == COALESCE_DEFERRED)
+    {
+        if (manager->reuse_count == REUSE_LIST_SIZE)
+        {
+            // Drop the oldest entry
+            memmove(manager->reuse_list, manager->reuse_list + 1, sizeof(MemSize) * (REUSE_LIST_SIZE - 1));
+            manager->reuse_count--;
+        }
+        manager->reuse_list[manager->reuse_count++] = manager->blocks[index].start_address;
+        manager->pending_frees++;
+
+        if (manager->verbose)
+            log_untimed(manager, "\nDeferred Coalescing: P%d's block at address %lld kept for reuse (%d pending frees)\n",
+                   process->id, manager->blocks[index].start_address, manager->pending_frees);
+
+        if (manager->pending_frees >= manager->coalesce_threshold)
+        {
+            coalesce_deferred_blocks(manager);
+        }
+        return;
+    }
+
     // Coalescing: merge adjacent free blocks
     bool merged;
     int coalesce_operations = 0;
+    long long coalesce_start = (manager->latency != NULL) ? now_ns() : 0;
+    long long untimed = manager->untimed_ns;
 
-    printf("\nCoalescing Process: Checking for adjacent free blocks after P%d termination\n", process->id);
+    if (manager->verbose)
+        log_untimed(manager, "\nCoalescing Process: Checking for adjacent free blocks after P%d termination\n", process->id);
 
     do
     {
@@ -501,17 +1966,18 @@ void deallocate_memory(MemoryManager *manager, Process *process)
         for (int i = 0; i < manager->block_count - 1; i++)
         {
             // If this block and the next one are both free, merge them
-            if (manager->blocks[i].is_free && manager->blocks[i + 1].is_free)
+            if (is_block_free(&manager->blocks[i]) && is_block_free(&manager->blocks[i + 1]))
             {
-                printf("  Coalescing blocks at addresses %d and %d (sizes: %d KB + %d KB = %d KB)\n",
-                       manager->blocks[i].start_address,
-                       manager->blocks[i + 1].start_address,
-                       manager->blocks[i].size,
-                       manager->blocks[i + 1].size,
-                       manager->blocks[i].size + manager->blocks[i + 1].size);
+                if (manager->verbose)
+                    log_untimed(manager, "  Coalescing blocks at addresses %lld and %lld (sizes: %lld %s + %lld %s = %lld %s)\n",
+                           manager->blocks[i].start_address,
+                           manager->blocks[i + 1].start_address,
+                           get_block_size(&manager->blocks[i]), get_unit_name(),
+                           get_block_size(&manager->blocks[i + 1]), get_unit_name(),
+                           get_block_size(&manager->blocks[i]) + get_block_size(&manager->blocks[i + 1]), get_unit_name());
 
                 // Add the size of the next block to this one
-                manager->blocks[i].size += manager->blocks[i + 1].size;
+                set_block_size(&manager->blocks[i], get_block_size(&manager->blocks[i]) + get_block_size(&manager->blocks[i + 1]));
 
                 // Shift all subsequent blocks down
                 for (int j = i + 1; j < manager->block_count - 1; j++)
@@ -520,16 +1986,17 @@ void deallocate_memory(MemoryManager *manager, Process *process)
                 }
 
                 // Update process block indices that are affected by the shift
-                for (int j = 0; j < MAX_PROCESSES; j++)
+                for (int j = 0; j < manager->process_count; j++)
                 {
-                    if (process[j].block_index > i + 1)
+                    if (manager->process_table[j].block_index > i + 1)
                     {
-                        process[j].block_index--;
+                        manager->process_table[j].block_index--;
                     }
                 }
 
                 // Decrement the block count
                 manager->block_count--;
+                manager->merge_count++;
                 merged = true;
                 coalesce_operations++;
                 break; // Start the merging process again
@@ -537,59 +2004,488 @@ void deallocate_memory(MemoryManager *manager, Process *process)
         }
     } while (merged);
 
+    if (manager->latency != NULL)
+    {
+        latency_record(manager->latency, OP_COALESCE, now_ns() - coalesce_start - (manager->untimed_ns - untimed));
+    }
+
+    if (!manager->verbose)
+    {
+        return;
+    }
+
     if (coalesce_operations == 0)
     {
-        printf("  No adjacent free blocks found for coalescing\n");
+        log_untimed(manager, "  No adjacent free blocks found for coalescing\n");
     }
     else
     {
-        printf("  Completed %d coalescing operations\n", coalesce_operations);
+        log_untimed(manager, "  Completed %d coalescing operations\n", coalesce_operations);
     }
 }
 
 /**
- * Read processes from input file
+ * Merge every pair of adjacent free blocks left by deferred frees
+ *
+ * Returns:
+ *   Number of merges performed
  */
-bool read_processes_from_file(const char *filename, Process processes[], int *num_processes, int *memory_size)
+int coalesce_deferred_blocks(MemoryManager *manager)
 {
-    printf("Attempting to open file: %s\n", filename);
-    
-    FILE *input_file = fopen(filename, "r");
-    if (input_file == NULL)
-    {
-        fprintf(stderr, "Error: Could not open input file '%s'\n", filename);
-        return false;
-    }
+    long long start = (manager->latency != NULL) ? now_ns() : 0;
+    int blocks_before = manager->block_count;
 
-    char line[MAX_LINE_LENGTH];
-    int line_number = 0;
+    coalesce_memory(manager, manager->process_table);
 
-    // Read first line for memory size
-    if (fgets(line, MAX_LINE_LENGTH, input_file) != NULL)
+    int merges = blocks_before - manager->block_count;
+    manager->deferred_merges += merges;
+    manager->pending_frees = 0;
+    manager->reuse_count = 0;
+
+    if (manager->latency != NULL)
     {
-        line_number++;
-        int mem_size;
-        if (sscanf(line, "%d", &mem_size) == 1)
-        {
-            *memory_size = mem_size;
-        }
+        latency_record(manager->latency, OP_COALESCE, now_ns() - start);
     }
-
-    // Read subsequent lines for process information
-    *num_processes = 0;
-    while (fgets(line, MAX_LINE_LENGTH, input_file) != NULL && *num_processes < MAX_PROCESSES)
+    if (manager->verbose)
     {
-        line_number++;
+        log_untimed(manager, "  Batched coalescing: %d merges\n", merges);
+    }
+    return merges;
+}
 
-        // Skip empty lines and comments
-        if (line[0] == '\n' || line[0] == '#')
-        {
-            continue;
-        }
+/**
+ * Free a slot in the block array for a split by merging pending frees
+ *
+ * Used when the array cannot grow. Merging can move and grow the chosen hole, so it is looked up again by the
+ * address it started at; it still holds the request and still needs a split.
+ *
+ * Returns:
+ *   New index of the hole, or -1 if nothing could be merged
+ */
+int make_room_for_split(MemoryManager *manager, int block_index)
+{
+    MemSize address = manager->blocks[block_index].start_address;
 
-        // Parse process information: ID Size ArrivalTime Duration
-        int id, size, arrival_time = 0, duration = 10;
-        int fields = sscanf(line, "%d %d %d %d", &id, &size, &arrival_time, &duration);
+    if (manager->coalesce_policy != COALESCE_DEFERRED || coalesce_deferred_blocks(manager) == 0)
+    {
+        return -1;
+    }
+    return find_block_containing(manager, address);
+}
+
+/**
+ * Take a recently freed block that fits without needing a split
+ *
+ * A block qualifies when it holds the request and the remainder is too small
+ * to split off, i.e. the request would reuse the freed hole as it is.
+ *
+ * Returns:
+ *   Index of the block, or -1 if no entry in the reuse list fits
+ */
+int take_reusable_block(MemoryManager *manager, MemSize size)
+{
+    // Newest first: the most recently freed hole is the likeliest exact match
+    for (int i = manager->reuse_count - 1; i >= 0; i--)
+    {
+        int index = find_block_containing(manager, manager->reuse_list[i]);
+        if (index == -1 || !is_block_free(&manager->blocks[index]) ||
+            manager->blocks[index].start_address != manager->reuse_list[i])
+        {
+            continue;
+        }
+
+        MemSize block_size = get_block_size(&manager->blocks[index]);
+        if (block_size >= size && !should_split(manager, block_size, size))
+        {
+            memmove(manager->reuse_list + i, manager->reuse_list + i + 1,
+                    sizeof(MemSize) * (manager->reuse_count - i - 1));
+            manager->reuse_count--;
+            manager->quick_reuse_hits++;
+            return index;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Get the display name of a coalescing policy
+ */
+const char *get_coalesce_policy_name(CoalescePolicy policy)
+{
+    return policy == COALESCE_DEFERRED ? "Deferred" : "Immediate";
+}
+
+/**
+ * Locate the block containing an address
+ *
+ * Blocks are kept sorted by start address, so this is a binary search.
+ *
+ * Returns:
+ *   Index of the block containing the address, or -1 if it is out of range
+ */
+int find_block_containing(MemoryManager *manager, MemSize address)
+{
+    int low = 0, high = manager->block_count - 1;
+
+    while (low <= high)
+    {
+        int mid = low + (high - low) / 2;
+        MemoryBlock *block = &manager->blocks[mid];
+
+        if (address < block->start_address)
+            high = mid - 1;
+        else if (address >= block->start_address + get_block_size(block))
+            low = mid + 1;
+        else
+            return mid;
+    }
+    return -1;
+}
+
+/**
+ * Create a page bitmap covering the given amount of memory
+ *
+ * The page size starts at BITMAP_PAGE_BYTES and doubles until the page count
+ * fits in BITMAP_MAX_PAGES, so very large memories keep a bounded bitmap.
+ * Bits past the last whole page are marked allocated so they are never handed out.
+ */
+PageBitmap *bitmap_create(MemSize total_size)
+{
+    PageBitmap *bitmap = malloc(sizeof(PageBitmap));
+    if (bitmap == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate page bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bitmap->page_size = bytes_to_units(BITMAP_PAGE_BYTES);
+    while (total_size / bitmap->page_size > BITMAP_MAX_PAGES)
+    {
+        bitmap->page_size *= 2;
+    }
+
+    bitmap->page_count = (int)(total_size / bitmap->page_size); // At most BITMAP_MAX_PAGES
+    bitmap->word_count = (bitmap->page_count + 63) / 64 + 1;
+    bitmap->summary_count = (bitmap->word_count + 63) / 64;
+    bitmap->words = calloc(bitmap->word_count, sizeof(uint64_t));
+    bitmap->full_words = calloc(bitmap->summary_count, sizeof(uint64_t));
+    bitmap->empty_words = calloc(bitmap->summary_count, sizeof(uint64_t));
+    if (bitmap->words == NULL || bitmap->full_words == NULL || bitmap->empty_words == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate page bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Everything past the last page counts as allocated
+    int tail = bitmap->page_count % 64;
+    int first_tail_word = bitmap->page_count / 64;
+    if (tail != 0)
+    {
+        bitmap->words[first_tail_word] = ~0ULL << tail;
+        first_tail_word++;
+    }
+    for (int w = first_tail_word; w < bitmap->word_count; w++)
+    {
+        bitmap->words[w] = ~0ULL;
+    }
+
+    for (int w = 0; w < bitmap->word_count; w++)
+    {
+        bitmap_update_summary(bitmap, w);
+    }
+
+    return bitmap;
+}
+
+/**
+ * Free a page bitmap
+ */
+void bitmap_destroy(PageBitmap *bitmap)
+{
+    if (bitmap == NULL)
+    {
+        return;
+    }
+    free(bitmap->words);
+    free(bitmap->full_words);
+    free(bitmap->empty_words);
+    free(bitmap);
+}
+
+/**
+ * Copy a page bitmap (NULL stays NULL)
+ */
+PageBitmap *bitmap_clone(const PageBitmap *bitmap)
+{
+    if (bitmap == NULL)
+    {
+        return NULL;
+    }
+
+    PageBitmap *copy = malloc(sizeof(PageBitmap));
+    if (copy == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate page bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+    *copy = *bitmap;
+    copy->words = malloc(sizeof(uint64_t) * bitmap->word_count);
+    copy->full_words = malloc(sizeof(uint64_t) * bitmap->summary_count);
+    copy->empty_words = malloc(sizeof(uint64_t) * bitmap->summary_count);
+    if (copy->words == NULL || copy->full_words == NULL || copy->empty_words == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate page bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy->words, bitmap->words, sizeof(uint64_t) * bitmap->word_count);
+    memcpy(copy->full_words, bitmap->full_words, sizeof(uint64_t) * bitmap->summary_count);
+    memcpy(copy->empty_words, bitmap->empty_words, sizeof(uint64_t) * bitmap->summary_count);
+    return copy;
+}
+
+/**
+ * Refresh the summary bits for one bitmap word
+ */
+void bitmap_update_summary(PageBitmap *bitmap, int word)
+{
+    uint64_t bit = 1ULL << (word % 64);
+    int summary = word / 64;
+
+    if (bitmap->words[word] == ~0ULL)
+        bitmap->full_words[summary] |= bit;
+    else
+        bitmap->full_words[summary] &= ~bit;
+
+    if (bitmap->words[word] == 0)
+        bitmap->empty_words[summary] |= bit;
+    else
+        bitmap->empty_words[summary] &= ~bit;
+}
+
+/**
+ * Mark a range of pages as allocated or free
+ */
+void bitmap_set_range(PageBitmap *bitmap, int first_page, int page_count, bool used)
+{
+    int page = first_page;
+    int end = first_page + page_count;
+
+    while (page < end)
+    {
+        int word = page / 64;
+        int offset = page % 64;
+        int bits = (end - page < 64 - offset) ? end - page : 64 - offset;
+        uint64_t mask = (bits == 64) ? ~0ULL : ((1ULL << bits) - 1) << offset;
+
+        if (used)
+            bitmap->words[word] |= mask;
+        else
+            bitmap->words[word] &= ~mask;
+
+        bitmap_update_summary(bitmap, word);
+        page += bits;
+    }
+}
+
+/**
+ * Find the first word at or after 'word' whose summary bit is clear
+ *
+ * With 'summary' set to full_words this skips fully allocated words, with
+ * empty_words it skips fully free words, 4096 pages per summary word.
+ */
+static int bitmap_skip_words(PageBitmap *bitmap, const uint64_t *summary, int word)
+{
+    int index = word / 64;
+    if (index >= bitmap->summary_count)
+    {
+        return bitmap->word_count;
+    }
+
+    uint64_t candidates = ~summary[index] & (~0ULL << (word % 64));
+    while (candidates == 0)
+    {
+        if (++index >= bitmap->summary_count)
+        {
+            return bitmap->word_count;
+        }
+        candidates = ~summary[index];
+    }
+    return index * 64 + __builtin_ctzll(candidates);
+}
+
+/**
+ * Find the first free page at or after 'page' (page_count if none)
+ */
+int bitmap_next_free(PageBitmap *bitmap, int page)
+{
+    if (page >= bitmap->page_count)
+    {
+        return bitmap->page_count;
+    }
+
+    int word = page / 64;
+    uint64_t free_bits = ~bitmap->words[word] & (~0ULL << (page % 64));
+    if (free_bits == 0)
+    {
+        word = bitmap_skip_words(bitmap, bitmap->full_words, word + 1);
+        if (word >= bitmap->word_count)
+        {
+            return bitmap->page_count;
+        }
+        free_bits = ~bitmap->words[word];
+    }
+
+    int result = word * 64 + __builtin_ctzll(free_bits);
+    return result < bitmap->page_count ? result : bitmap->page_count;
+}
+
+/**
+ * Find the first allocated page at or after 'page' (page_count if none)
+ */
+int bitmap_next_used(PageBitmap *bitmap, int page)
+{
+    if (page >= bitmap->page_count)
+    {
+        return bitmap->page_count;
+    }
+
+    int word = page / 64;
+    uint64_t used_bits = bitmap->words[word] & (~0ULL << (page % 64));
+    if (used_bits == 0)
+    {
+        word = bitmap_skip_words(bitmap, bitmap->empty_words, word + 1);
+        if (word >= bitmap->word_count)
+        {
+            return bitmap->page_count;
+        }
+        used_bits = bitmap->words[word];
+    }
+
+    int result = word * 64 + __builtin_ctzll(used_bits);
+    return result < bitmap->page_count ? result : bitmap->page_count;
+}
+
+/**
+ * Update the page bitmap after a block changed state
+ */
+void bitmap_mark_block(MemoryManager *manager, int block_index, bool used)
+{
+    PageBitmap *bitmap = manager->bitmap;
+    if (bitmap == NULL)
+    {
+        return;
+    }
+
+    MemoryBlock *block = &manager->blocks[block_index];
+    int first_page = (int)(block->start_address / bitmap->page_size);
+    int end_page = (int)((block->start_address + get_block_size(block) + bitmap->page_size - 1) / bitmap->page_size);
+    if (end_page > bitmap->page_count)
+    {
+        end_page = bitmap->page_count;
+    }
+
+    if (end_page > first_page)
+    {
+        bitmap_set_range(bitmap, first_page, end_page - first_page, used);
+    }
+}
+
+/**
+ * Find the lowest run of free pages that fits the requested size (Bitmap Fit)
+ *
+ * Free and allocated runs are located with count-trailing-zeros on 64-page
+ * words, and whole words are skipped through the summary bitmaps, so the
+ * search cost depends on the number of runs rather than the memory size.
+ *
+ * Returns:
+ *   Index of the free block starting at that run, or -1 if no run is long enough
+ */
+int find_bitmap_fit(MemoryManager *manager, MemSize size)
+{
+    PageBitmap *bitmap = manager->bitmap;
+    MemSize pages_needed = (size + bitmap->page_size - 1) / bitmap->page_size;
+    int page = 0;
+
+    while (page < bitmap->page_count)
+    {
+        int run_start = bitmap_next_free(bitmap, page);
+        if (run_start >= bitmap->page_count)
+        {
+            break;
+        }
+
+        int run_end = bitmap_next_used(bitmap, run_start);
+        if (run_end - run_start >= pages_needed)
+        {
+            int index = find_block_containing(manager, run_start * bitmap->page_size);
+            if (index != -1 && is_block_free(&manager->blocks[index]) && get_block_size(&manager->blocks[index]) >= size)
+            {
+                return index;
+            }
+            // Run spans blocks that have not been merged yet
+            return find_first_fit(manager, size);
+        }
+        page = run_end;
+    }
+
+    return -1;
+}
+
+/**
+ * Read processes from input file
+ *
+ * The process table is allocated here and grows with the file; the caller
+ * frees it. It always has one entry beyond *num_processes to spare.
+ */
+bool read_processes_from_file(const char *filename, Process **processes, int *num_processes, MemSize *memory_size)
+{
+    printf("Attempting to open file: %s\n", filename);
+    
+    FILE *input_file = fopen(filename, "r");
+    if (input_file == NULL)
+    {
+        fprintf(stderr, "Error: Could not open input file '%s'\n", filename);
+        return false;
+    }
+
+    char line[MAX_LINE_LENGTH];
+    int line_number = 0;
+
+    // Read first line for memory size
+    if (fgets(line, MAX_LINE_LENGTH, input_file) != NULL)
+    {
+        line_number++;
+        MemSize mem_size;
+        if (sscanf(line, "%lld", &mem_size) == 1)
+        {
+            *memory_size = mem_size;
+        }
+    }
+
+    // Read subsequent lines for process information; the table grows with the
+    // file, so long traces load completely
+    int capacity = INITIAL_PROCESS_CAPACITY;
+    Process *table = malloc(sizeof(Process) * (size_t)capacity);
+    if (table == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate process table\n");
+        exit(EXIT_FAILURE);
+    }
+    *num_processes = 0;
+    while (fgets(line, MAX_LINE_LENGTH, input_file) != NULL)
+    {
+        line_number++;
+
+        // Skip empty lines and comments
+        if (line[0] == '\n' || line[0] == '#')
+        {
+            continue;
+        }
+
+        // Parse process information: ID Size ArrivalTime Duration
+        int id, arrival_time = 0, duration = 10;
+        MemSize size;
+        int fields = sscanf(line, "%d %lld %d %d", &id, &size, &arrival_time, &duration);
 
         if (fields < 2)
         {
@@ -600,15 +2496,37 @@ bool read_processes_from_file(const char *filename, Process processes[], int *nu
         // Validate process size
         if (size <= 0)
         {
-            fprintf(stderr, "Warning: Line %d in input file has invalid process size (%d), skipping\n", line_number, size);
+            fprintf(stderr, "Warning: Line %d in input file has invalid process size (%lld), skipping\n", line_number, size);
             continue;
         }
 
+        // Keep one spare entry for the large process added in phase 4
+        if (*num_processes + 1 >= capacity)
+        {
+            if (capacity > INT_MAX / 2)
+            {
+                fprintf(stderr, "Error: Too many processes in input file\n");
+                exit(EXIT_FAILURE);
+            }
+            capacity *= 2;
+            Process *grown = realloc(table, sizeof(Process) * (size_t)capacity);
+            if (grown == NULL)
+            {
+                fprintf(stderr, "Error: Could not allocate process table\n");
+                exit(EXIT_FAILURE);
+            }
+            table = grown;
+        }
+
         // Initialize process
-        processes[*num_processes].id = id;
-        processes[*num_processes].size = size;
-        processes[*num_processes].state = PROCESS_NEW;
-        processes[*num_processes].block_index = -1;
+        Process *process = &table[*num_processes];
+        memset(process, 0, sizeof(Process));
+        process->id = id;
+        process->size = size;
+        process->state = PROCESS_NEW;
+        process->block_index = -1;
+        process->arrival_time = arrival_time > 0 ? arrival_time : 0;
+        process->duration = duration > 0 ? duration : 0;
 
         (*num_processes)++;
     }
@@ -618,9 +2536,11 @@ bool read_processes_from_file(const char *filename, Process processes[], int *nu
     if (*num_processes == 0)
     {
         fprintf(stderr, "Warning: No valid processes found in input file\n");
+        free(table);
         return false;
     }
 
+    *processes = table;
     return true;
 }
 
@@ -630,17 +2550,17 @@ bool read_processes_from_file(const char *filename, Process processes[], int *nu
 void print_memory_state_simplified(MemoryManager *manager, Process processes[], int num_processes)
 {
     // Print memory usage summary
-    printf("\nMemory Summary: Used: %d KB (%.1f%%), Free: %d KB (%.1f%%)\n",
-           manager->total_size - manager->free_size,
+    printf("\nMemory Summary: Used: %lld %s (%.1f%%), Free: %lld %s (%.1f%%)\n",
+           manager->total_size - manager->free_size, get_unit_name(),
            ((double)(manager->total_size - manager->free_size) / manager->total_size) * 100.0,
-           manager->free_size,
+           manager->free_size, get_unit_name(),
            ((double)manager->free_size / manager->total_size) * 100.0);
 
     // Count free blocks
     int free_block_count = 0;
     for (int i = 0; i < manager->block_count; i++)
     {
-        if (manager->blocks[i].is_free)
+        if (is_block_free(&manager->blocks[i]))
             free_block_count++;
     }
 
@@ -648,7 +2568,7 @@ void print_memory_state_simplified(MemoryManager *manager, Process processes[],
     printf("Blocks: Total: %d, Free: %d\n", manager->block_count, free_block_count);
 
     // Print process count
-    int running = 0, terminated = 0, new_count = 0;
+    int running = 0, terminated = 0, new_count = 0, waiting = 0, swapped = 0;
     for (int i = 0; i < num_processes; i++)
     {
         if (processes[i].state == PROCESS_RUNNING)
@@ -657,10 +2577,19 @@ void print_memory_state_simplified(MemoryManager *manager, Process processes[],
             terminated++;
         else if (processes[i].state == PROCESS_NEW)
             new_count++;
+        else if (processes[i].state == PROCESS_WAITING)
+            waiting++;
+        else if (processes[i].state == PROCESS_SWAPPED)
+            swapped++;
     }
 
-    printf("Processes: Running: %d, Terminated: %d, Unallocated: %d\n",
+    printf("Processes: Running: %d, Terminated: %d, Unallocated: %d",
            running, terminated, new_count);
+    if (waiting > 0)
+        printf(", Waiting: %d", waiting);
+    if (swapped > 0)
+        printf(", Swapped: %d", swapped);
+    printf("\n");
 }
 
 /**
@@ -677,16 +2606,19 @@ void print_memory_state_detailed(MemoryManager *manager, Process processes[], in
     {
         if (processes[i].state != PROCESS_NEW)
         {
-            const char *state_str = (processes[i].state == PROCESS_RUNNING) ? "Running" : "Terminated";
+            const char *state_str = (processes[i].state == PROCESS_RUNNING)   ? "Running"
+                                    : (processes[i].state == PROCESS_WAITING) ? "Waiting"
+                                    : (processes[i].state == PROCESS_SWAPPED) ? "Swapped"
+                                                                              : "Terminated";
 
-            printf("%-4d %-15s %-12d ",
+            printf("%-4d %-15s %-12lld ",
                    processes[i].id,
                    state_str,
                    processes[i].size);
 
             if (processes[i].block_index != -1)
             {
-                printf("%-12d\n", manager->blocks[processes[i].block_index].start_address);
+                printf("%-12lld\n", manager->blocks[processes[i].block_index].start_address);
             }
             else
             {
@@ -697,10 +2629,18 @@ void print_memory_state_detailed(MemoryManager *manager, Process processes[], in
 
     // Print memory usage summary
     printf("\nMemory Status:\n");
-    printf("Total Memory: %d KB, Used: %d KB, Free: %d KB\n",
-           manager->total_size,
-           manager->total_size - manager->free_size,
-           manager->free_size);
+    printf("Total Memory: %lld %s, Used: %lld %s, Free: %lld %s\n",
+           manager->total_size, get_unit_name(),
+           manager->total_size - manager->free_size, get_unit_name(),
+           manager->free_size, get_unit_name());
+
+    print_memory_map(manager, MEM_VISUAL_SIZE);
+
+    if (manager->block_count > MAX_LISTED_BLOCKS)
+    {
+        printf("\n(%d blocks; block list omitted, see the memory map)\n\n", manager->block_count);
+        return;
+    }
 
     // Print block details
     printf("\nBlock List Details:\n");
@@ -709,16 +2649,76 @@ void print_memory_state_detailed(MemoryManager *manager, Process processes[], in
 
     for (int i = 0; i < manager->block_count; i++)
     {
-        printf("%-8d %-8d %-16s %-8d\n",
+        // Blocks do not store their owner; find it in the process table
+        int owner = -1;
+        for (int j = 0; j < num_processes && !is_block_free(&manager->blocks[i]); j++)
+        {
+            if (processes[j].block_index == i)
+                owner = processes[j].id;
+        }
+
+        printf("%-8lld %-8lld %-16s %-8d\n",
                manager->blocks[i].start_address,
-               manager->blocks[i].size,
-               manager->blocks[i].is_free ? "Free" : "Allocated",
-               manager->blocks[i].process_id);
+               get_block_size(&manager->blocks[i]),
+               is_block_free(&manager->blocks[i]) ? "Free" : "Allocated",
+               owner);
     }
 
     printf("\n");
 }
 
+/**
+ * Print the whole address space as a fixed-width memory map
+ *
+ * The first row shows occupancy per cell (' ' free through '@' full), sampled
+ * at MEM_MAP_SAMPLES points; the second shows fragmentation density as the
+ * number of block boundaries inside the cell ('+' for 10 or more). Every
+ * value comes from binary searches of the sorted block array, so rendering
+ * costs O(width * log n) however many blocks there are.
+ */
+void print_memory_map(MemoryManager *manager, int width)
+{
+    static const char ramp[] = " .:-=+*#%@";
+    char occupancy[MEM_VISUAL_SIZE + 1];
+    char density[MEM_VISUAL_SIZE + 1];
+    MemSize total = manager->total_size;
+
+    if (width > MEM_VISUAL_SIZE)
+        width = MEM_VISUAL_SIZE;
+
+    for (int c = 0; c < width; c++)
+    {
+        // Cell bounds, written to avoid overflowing total * c
+        MemSize low = c * (total / width) + c * (total % width) / width;
+        MemSize high = (c + 1) * (total / width) + (c + 1) * (total % width) / width;
+        if (high <= low)
+            high = low + 1;
+
+        int first = find_block_containing(manager, low);
+        int last = find_block_containing(manager, high - 1);
+
+        int used = 0;
+        for (int k = 0; k < MEM_MAP_SAMPLES; k++)
+        {
+            MemSize address = low + (high - low) * (2 * k + 1) / (2 * MEM_MAP_SAMPLES);
+            int index = find_block_containing(manager, address);
+            if (index != -1 && !is_block_free(&manager->blocks[index]))
+                used++;
+        }
+
+        int boundaries = (first == -1 || last == -1) ? 0 : last - first;
+        occupancy[c] = ramp[(used * (int)(sizeof(ramp) - 2) + MEM_MAP_SAMPLES / 2) / MEM_MAP_SAMPLES];
+        density[c] = boundaries == 0 ? ' ' : boundaries < 10 ? (char)('0' + boundaries) : '+';
+    }
+    occupancy[width] = '\0';
+    density[width] = '\0';
+
+    printf("\nMemory Map (%lld %s per cell, occupancy ' ' to '@', digits = block boundaries):\n",
+           (total + width - 1) / width, get_unit_name());
+    printf("  |%s| %lld %s\n", occupancy, total, get_unit_name());
+    printf("  |%s|\n", density);
+}
+
 /**
  * Calculate and update fragmentation metrics
  */
@@ -729,19 +2729,38 @@ void update_fragmentation_metrics(MemoryManager *manager, Process processes[],
     stats->external_fragmentation = 0;
     stats->fragmentation_percentage = 0.0;
     stats->avg_fragment_size = 0.0;
+    stats->internal_fragmentation = manager->internal_fragmentation;
+    stats->padding_fragmentation = manager->padding_fragmentation;
+    stats->slack_fragmentation = manager->slack_fragmentation;
 
-    int total_free_size = 0;
+    stats->unmerged_free_blocks = 0;
+    stats->merge_count = manager->merge_count;
+    stats->deferred_merges = manager->deferred_merges;
+    stats->quick_reuse_hits = manager->quick_reuse_hits;
+
+    MemSize total_free_size = 0;
     int free_block_count = 0;
+    MemSize largest_free_block = 0;
 
-    // Count free blocks
+    // Count free holes; adjacent free blocks left by deferred coalescing
+    // form a single hole, so both policies are measured the same way
     for (int i = 0; i < manager->block_count; i++)
     {
-        if (manager->blocks[i].is_free)
+        if (!is_block_free(&manager->blocks[i]))
+            continue;
+
+        MemSize hole_size = get_block_size(&manager->blocks[i]);
+        while (i + 1 < manager->block_count && is_block_free(&manager->blocks[i + 1]))
         {
-            stats->external_fragmentation++;
-            total_free_size += manager->blocks[i].size;
-            free_block_count++;
+            hole_size += get_block_size(&manager->blocks[++i]);
+            stats->unmerged_free_blocks++;
         }
+
+        stats->external_fragmentation++;
+        total_free_size += hole_size;
+        free_block_count++;
+        if (hole_size > largest_free_block)
+            largest_free_block = hole_size;
     }
 
     // Calculate average fragment size if there are any fragments
@@ -753,19 +2772,9 @@ void update_fragmentation_metrics(MemoryManager *manager, Process processes[],
     // Calculate fragmentation percentage
     if (manager->free_size > 0)
     {
-        // If there's more than one free block, we have fragmentation
+        // If there's more than one free hole, we have fragmentation
         if (free_block_count > 1)
         {
-            // Find the largest free block
-            int largest_free_block = 0;
-            for (int i = 0; i < manager->block_count; i++)
-            {
-                if (manager->blocks[i].is_free && manager->blocks[i].size > largest_free_block)
-                {
-                    largest_free_block = manager->blocks[i].size;
-                }
-            }
-
             // External fragmentation percentage
             stats->fragmentation_percentage =
                 ((double)(manager->free_size - largest_free_block) / manager->free_size) * 100.0;
@@ -774,57 +2783,482 @@ void update_fragmentation_metrics(MemoryManager *manager, Process processes[],
 }
 
 /**
- * Run a simulation with the specified allocation strategy
+ * Sample current memory utilization into the statistics
  */
-void run_simulation(MemoryManager *manager, AllocationStrategy strategy,
-                    Process processes[], int num_processes, Statistics *stats)
+void record_utilization(MemoryManager *manager, Statistics *stats)
 {
-    // Initialize statistics
-    memset(stats, 0, sizeof(Statistics));
+    double current_utilization = (double)(manager->total_size - manager->free_size) / manager->total_size;
 
-    // Print allocation strategy
-    printf("\n=== %s Strategy Simulation ===\n",
-           strategy == FIRST_FIT ? "First-Fit" : (strategy == BEST_FIT ? "Best-Fit" : "Worst-Fit"));
+    stats->utilization_sum += current_utilization;
+    stats->utilization_samples++;
+    if (current_utilization > stats->peak_utilization)
+    {
+        stats->peak_utilization = current_utilization;
+    }
+}
 
-    // --- Phase 1: Initial Process Allocation ---
-    printf("\n--- Phase 1: Initial Process Allocation ---\n");
-    int num_to_allocate;
-    printf("How many processes do you want to allocate initially? (max %d): ", num_processes);
-    scanf("%d", &num_to_allocate);
+/* One request of a batch, with its position in the original order */
+typedef struct
+{
+    Process *process;  // Requesting process
+    int position;      // Index in the caller's request list
+    int hole;          // Hole it was placed in (-1 if not placed)
+    MemSize start;     // Placement address
+    MemSize size;      // Block size handed out (request plus unsplit slack)
+    int next_in_hole;  // Next placement in the same hole (-1 at the end)
+    int block_index;   // Block index after the rebuild
+} BatchRequest;
+
+/* A free block being carved up by a batch */
+typedef struct
+{
+    MemSize start;     // Start of the still-free part
+    MemSize remaining; // Size of the still-free part
+    int first;         // First placement in this hole (-1 if none)
+    int last;          // Last placement in this hole (-1 if none)
+} BatchHole;
 
-    if (num_to_allocate <= 0)
-        num_to_allocate = 1;
-    else if (num_to_allocate > num_processes)
-        num_to_allocate = num_processes;
+/**
+ * qsort comparator: larger requests first, ties in original order
+ */
+static int compare_batch_requests(const void *a, const void *b)
+{
+    const BatchRequest *left = a;
+    const BatchRequest *right = b;
 
-    double total_utilization = 0.0;
-    int utilization_samples = 0;
+    if (left->process->size != right->process->size)
+        return right->process->size > left->process->size ? 1 : -1;
+    return left->position - right->position;
+}
 
-    for (int i = 0; i < num_to_allocate; i++)
+/**
+ * Pick a hole for a request with the same rule the find_* functions use
+ */
+static int choose_batch_hole(const BatchHole holes[], int hole_count, MemSize size, AllocationStrategy strategy)
+{
+    int chosen = -1;
+
+    for (int h = 0; h < hole_count; h++)
     {
-        stats->allocation_attempts++;
+        if (holes[h].remaining < size)
+            continue;
+        if (strategy == FIRST_FIT)
+            return h;
+        if (chosen == -1 ||
+            (strategy == BEST_FIT && holes[h].remaining < holes[chosen].remaining) ||
+            (strategy == WORST_FIT && holes[h].remaining > holes[chosen].remaining))
+        {
+            chosen = h;
+        }
+    }
+    return chosen;
+}
+
+/**
+ * Size of the largest run of free memory
+ */
+MemSize largest_free_hole(MemoryManager *manager)
+{
+    MemSize largest = 0;
+
+    for (int i = 0; i < manager->block_count; i++)
+    {
+        MemSize hole_size = 0;
+        while (i < manager->block_count && is_block_free(&manager->blocks[i]))
+        {
+            hole_size += get_block_size(&manager->blocks[i++]);
+        }
+        if (hole_size > largest)
+            largest = hole_size;
+    }
+    return largest;
+}
+
+/**
+ * Place the requests one by one in input order on a scratch copy of the manager
+ */
+static void simulate_sequential_placement(MemoryManager *manager, Process *requests[], int count, BatchReport *report)
+{
+    MemoryManager scratch = *manager;
+    int table_size = manager->process_count > 0 ? manager->process_count : 1;
+    Process *table = malloc(sizeof(Process) * table_size);
+    if (table == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate scratch process table\n");
+        exit(EXIT_FAILURE);
+    }
+    if (manager->process_count > 0)
+    {
+        memcpy(table, manager->process_table, sizeof(Process) * manager->process_count);
+    }
+
+    scratch.blocks = NULL;
+    scratch.block_capacity = 0;
+    copy_blocks(&scratch, manager);
+    scratch.process_table = table;
+    scratch.verbose = false;
+    scratch.adaptive = NULL;
+    scratch.latency = NULL;
+    scratch.lifetime = NULL;
+    scratch.swap = NULL;
+    scratch.bitmap = bitmap_clone(manager->bitmap);
+
+    report->sequential_placed = 0;
+    report->sequential_size = 0;
+    for (int i = 0; i < count; i++)
+    {
+        // Use the scratch table's copy so block indices stay in sync
+        Process local = *requests[i];
+        Process *process = &local;
+        for (int j = 0; j < manager->process_count; j++)
+        {
+            if (&manager->process_table[j] == requests[i])
+                process = &table[j];
+        }
+
+        if (allocate_memory(&scratch, process))
+        {
+            report->sequential_placed++;
+            report->sequential_size += process->size;
+        }
+    }
+    report->sequential_largest_hole = largest_free_hole(&scratch);
+
+    bitmap_destroy(scratch.bitmap);
+    free(scratch.blocks);
+    free(table);
+}
+
+/**
+ * Allocate several processes at once
+ *
+ * Requests are optionally sorted largest first (First/Best/Worst Fit
+ * Decreasing), then placed against the current free holes in a single pass.
+ * Placements are only recorded during the pass; the block array is rebuilt
+ * and every process block index remapped once at the end, instead of
+ * shifting the array and the indices for every split.
+ *
+ * Bitmap Fit and adaptive runs place the sorted requests through
+ * allocate_memory instead, since they must see each allocation.
+ *
+ * Parameters:
+ *   manager - Pointer to the memory manager
+ *   requests - Processes to allocate (state PROCESS_NEW)
+ *   count - Number of requests
+ *   order - BATCH_ORDER_INPUT or BATCH_ORDER_DECREASING
+ *   report - If not NULL, filled with the comparison against sequential placement
+ *
+ * Returns:
+ *   Number of requests placed
+ */
+int allocate_memory_batch(MemoryManager *manager, Process *requests[], int count, BatchOrder order, BatchReport *report)
+{
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    if (report != NULL)
+    {
+        report->strategy = manager->strategy;
+        report->order = order;
+        report->requested = count;
+        simulate_sequential_placement(manager, requests, count, report);
+    }
+
+    BatchRequest *batch = malloc(sizeof(BatchRequest) * count);
+    if (batch == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate batch\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        batch[i].process = requests[i];
+        batch[i].position = i;
+        batch[i].hole = -1;
+        batch[i].next_in_hole = -1;
+    }
+    if (order == BATCH_ORDER_DECREASING)
+    {
+        qsort(batch, count, sizeof(BatchRequest), compare_batch_requests);
+    }
+
+    int placed = 0;
+
+    if (manager->strategy == BITMAP_FIT || manager->adaptive != NULL)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (allocate_memory(manager, batch[i].process))
+                placed++;
+        }
+    }
+    else
+    {
+        if (manager->coalesce_policy == COALESCE_DEFERRED && manager->pending_frees > 0)
+        {
+            coalesce_deferred_blocks(manager);
+        }
+
+        // Collect the free holes in address order
+        BatchHole *holes = malloc(sizeof(BatchHole) * (size_t)manager->block_count);
+        int *old_to_new = malloc(sizeof(int) * (size_t)manager->block_count);
+        if (holes == NULL || old_to_new == NULL)
+        {
+            fprintf(stderr, "Error: Could not allocate batch holes\n");
+            exit(EXIT_FAILURE);
+        }
+        int hole_count = 0;
+        for (int i = 0; i < manager->block_count; i++)
+        {
+            if (is_block_free(&manager->blocks[i]))
+            {
+                holes[hole_count].start = manager->blocks[i].start_address;
+                holes[hole_count].remaining = get_block_size(&manager->blocks[i]);
+                holes[hole_count].first = -1;
+                holes[hole_count].last = -1;
+                hole_count++;
+            }
+        }
+
+        // Place every request, carving from the front of its hole
+        int new_block_count = manager->block_count;
+        for (int i = 0; i < count; i++)
+        {
+            MemSize size = round_request_size(manager, batch[i].process->size);
+            int h = choose_batch_hole(holes, hole_count, size, manager->strategy);
+            if (h == -1)
+                continue;
+
+            // Same rule as allocate_memory
+            bool split = should_split(manager, holes[h].remaining, size);
+
+            batch[i].hole = h;
+            batch[i].start = holes[h].start;
+            batch[i].size = split ? size : holes[h].remaining;
+            holes[h].start += batch[i].size;
+            holes[h].remaining -= batch[i].size;
+            if (holes[h].last == -1)
+                holes[h].first = i;
+            else
+                batch[holes[h].last].next_in_hole = i;
+            holes[h].last = i;
+            if (split)
+                new_block_count++;
+            placed++;
+        }
+
+        // Rebuild the block array once
+        int capacity = new_block_count > manager->block_capacity ? new_block_count : manager->block_capacity;
+        MemoryBlock *rebuilt = malloc(sizeof(MemoryBlock) * (size_t)capacity);
+        if (rebuilt == NULL)
+        {
+            fprintf(stderr, "Error: Could not allocate block array\n");
+            exit(EXIT_FAILURE);
+        }
+        int block_count = 0;
+        int h = 0;
+        for (int i = 0; i < manager->block_count; i++)
+        {
+            if (!is_block_free(&manager->blocks[i]))
+            {
+                old_to_new[i] = block_count;
+                rebuilt[block_count++] = manager->blocks[i];
+                continue;
+            }
+
+            for (int r = holes[h].first; r != -1; r = batch[r].next_in_hole)
+            {
+                batch[r].block_index = block_count;
+                rebuilt[block_count].start_address = batch[r].start;
+                set_block(&rebuilt[block_count], batch[r].size, false);
+                block_count++;
+            }
+            old_to_new[i] = -1;
+            if (holes[h].remaining > 0)
+            {
+                old_to_new[i] = block_count;
+                rebuilt[block_count].start_address = holes[h].start;
+                set_block(&rebuilt[block_count], holes[h].remaining, true);
+                block_count++;
+            }
+            h++;
+        }
+
+        free(manager->blocks);
+        manager->blocks = rebuilt;
+        manager->block_capacity = capacity;
+        manager->block_count = block_count;
 
-        if (allocate_memory(manager, &processes[i]))
+        // One index update for the processes that were already placed
+        for (int j = 0; j < manager->process_count; j++)
+        {
+            if (manager->process_table[j].block_index != -1)
+            {
+                manager->process_table[j].block_index = old_to_new[manager->process_table[j].block_index];
+            }
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            if (batch[i].hole == -1)
+                continue;
+
+            Process *process = batch[i].process;
+            process->block_index = batch[i].block_index;
+            process->state = PROCESS_RUNNING;
+            if (manager->swap != NULL)
+                process->placed_at = ++manager->swap->clock;
+            manager->free_size -= batch[i].size;
+            MemSize request_size = round_request_size(manager, process->size);
+            manager->internal_fragmentation += batch[i].size - process->size;
+            manager->padding_fragmentation += request_size - process->size;
+            manager->slack_fragmentation += batch[i].size - request_size;
+        }
+        if (manager->swap != NULL)
+        {
+            swap_index_rebuild(manager);
+        }
+
+        free(holes);
+        free(old_to_new);
+    }
+
+    if (report != NULL)
+    {
+        report->placed = 0;
+        report->placed_size = 0;
+        for (int i = 0; i < count; i++)
+        {
+            if (requests[i]->state == PROCESS_RUNNING)
+            {
+                report->placed++;
+                report->placed_size += requests[i]->size;
+            }
+        }
+        report->largest_hole = largest_free_hole(manager);
+    }
+
+    free(batch);
+    return placed;
+}
+
+/**
+ * Print how a batch compared with placing the same requests one by one
+ */
+void print_batch_report(const BatchReport *report)
+{
+    const char *unit = get_unit_name();
+
+    printf("Batch (%s, %s order): placed %d/%d (%lld %s), largest hole %lld %s\n",
+           get_strategy_name(report->strategy),
+           report->order == BATCH_ORDER_DECREASING ? "decreasing" : "input",
+           report->placed, report->requested, report->placed_size, unit, report->largest_hole, unit);
+    printf("Sequential (input order): placed %d/%d (%lld %s), largest hole %lld %s\n",
+           report->sequential_placed, report->requested, report->sequential_size, unit,
+           report->sequential_largest_hole, unit);
+    printf("Packing gain: %+d processes, %+lld %s placed, %+lld %s largest hole\n",
+           report->placed - report->sequential_placed,
+           report->placed_size - report->sequential_size, unit,
+           report->largest_hole - report->sequential_largest_hole, unit);
+}
+
+/**
+ * Allocate a list of processes and print the outcome of each in input order
+ *
+ * Requests are placed one at a time unless --batch is given, in which case
+ * they go through allocate_memory_batch and the packing gain is reported.
+ * As in admit_request, a FIFO queue that already holds waiters takes the
+ * whole batch without placing any of it.
+ */
+void allocate_requests(MemoryManager *manager, Process *requests[], int count, Statistics *stats)
+{
+    BatchReport report;
+    bool placed_batch = sim_options.batch &&
+                        !(manager->queue != NULL && manager->queue->policy == QUEUE_FIFO && manager->queue->count > 0);
+
+    if (placed_batch)
+    {
+        allocate_memory_batch(manager, requests, count, sim_options.batch_order, &report);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        bool allocated;
+        if (sim_options.batch)
+        {
+            allocated = requests[i]->state == PROCESS_RUNNING;
+            if (manager->queue != NULL)
+            {
+                queue_tick(manager->queue);
+                if (!allocated)
+                    queue_enqueue(manager, requests[i]);
+            }
+        }
+        else
+        {
+            allocated = admit_request(manager, requests[i]);
+        }
+
+        // A queued request counts as failed on arrival; the queue report shows when it got in
+        stats->allocation_attempts++;
+        if (allocated)
         {
             stats->successful_allocations++;
-            printf("P%d ", processes[i].id);
+            printf("P%d ", requests[i]->id);
         }
         else
         {
             stats->failed_allocations++;
-            printf("P%d(FAILED) ", processes[i].id);
+            printf(requests[i]->state == PROCESS_WAITING ? "P%d(WAITING) " : "P%d(FAILED) ", requests[i]->id);
         }
     }
     printf("\n");
 
-    double current_utilization = (double)(manager->total_size - manager->free_size) / manager->total_size;
-    total_utilization += current_utilization;
-    utilization_samples++;
-    stats->peak_utilization = current_utilization;
+    if (placed_batch && count > 0)
+    {
+        print_batch_report(&report);
+    }
+}
+
+/**
+ * Phase 1: allocate the first N processes in input order
+ */
+void run_initial_allocation_phase(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats)
+{
+    printf("\n--- Phase 1: Initial Process Allocation ---\n");
+    int num_to_allocate;
+    printf("How many processes do you want to allocate initially? (max %d): ", num_processes);
+    scanf("%d", &num_to_allocate);
+
+    if (num_to_allocate <= 0)
+        num_to_allocate = 1;
+    else if (num_to_allocate > num_processes)
+        num_to_allocate = num_processes;
+
+    Process **requests = malloc(sizeof(Process *) * (size_t)num_to_allocate);
+    if (requests == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate requests\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < num_to_allocate; i++)
+    {
+        requests[i] = &processes[i];
+    }
+    allocate_requests(manager, requests, num_to_allocate, stats);
+    free(requests);
 
+    record_utilization(manager, stats);
     print_memory_state_simplified(manager, processes, num_processes);
+}
 
-    // --- Phase 2: Process Termination ---
+/**
+ * Phase 2: terminate all or selected running processes
+ */
+void run_termination_phase(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats)
+{
     printf("\n--- Phase 2: Process Termination ---\n");
     printf("Running processes: ");
     int running_count = 0;
@@ -892,13 +3326,15 @@ void run_simulation(MemoryManager *manager, AllocationStrategy strategy,
         printf("No running processes to terminate.\n");
     }
 
-    current_utilization = (double)(manager->total_size - manager->free_size) / manager->total_size;
-    total_utilization += current_utilization;
-    utilization_samples++;
-
+    record_utilization(manager, stats);
     print_memory_state_simplified(manager, processes, num_processes);
+}
 
-    // --- Phase 3: Additional Process Allocation ---
+/**
+ * Phase 3: allocate more of the processes that are still unallocated
+ */
+void run_additional_allocation_phase(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats)
+{
     printf("\n--- Phase 3: Additional Process Allocation ---\n");
     printf("Remaining unallocated processes: ");
     int unallocated_count = 0;
@@ -923,46 +3359,38 @@ void run_simulation(MemoryManager *manager, AllocationStrategy strategy,
         if (more_to_allocate > unallocated_count)
             more_to_allocate = unallocated_count;
 
+        Process **requests = malloc(sizeof(Process *) * ((size_t)more_to_allocate + 1));
+        if (requests == NULL)
+        {
+            fprintf(stderr, "Error: Could not allocate requests\n");
+            exit(EXIT_FAILURE);
+        }
         int allocated_count = 0;
 
         for (int i = 0; i < num_processes && allocated_count < more_to_allocate; i++)
         {
             if (processes[i].state == PROCESS_NEW)
             {
-                stats->allocation_attempts++;
-
-                if (allocate_memory(manager, &processes[i]))
-                {
-                    stats->successful_allocations++;
-                    printf("P%d ", processes[i].id);
-                }
-                else
-                {
-                    stats->failed_allocations++;
-                    printf("P%d(FAILED) ", processes[i].id);
-                }
-
-                allocated_count++;
+                requests[allocated_count++] = &processes[i];
             }
         }
-        printf("\n");
+        allocate_requests(manager, requests, allocated_count, stats);
+        free(requests);
     }
     else
     {
         printf("No more processes to allocate.\n");
     }
 
-    current_utilization = (double)(manager->total_size - manager->free_size) / manager->total_size;
-    total_utilization += current_utilization;
-    utilization_samples++;
-    if (current_utilization > stats->peak_utilization)
-    {
-        stats->peak_utilization = current_utilization;
-    }
-
+    record_utilization(manager, stats);
     print_memory_state_simplified(manager, processes, num_processes);
+}
 
-    // --- Phase 4: Large Process Allocation ---
+/**
+ * Phase 4: try to fit one large process sized as a share of free memory
+ */
+void run_large_allocation_phase(MemoryManager *manager, Process processes[], int *num_processes, Statistics *stats)
+{
     printf("\n--- Phase 4: Large Process Allocation ---\n");
     float percent_input = 0.0f;
     do
@@ -983,61 +3411,4382 @@ void run_simulation(MemoryManager *manager, AllocationStrategy strategy,
         }
     } while (percent_input == 0.0f);
 
-    int large_size = (int)((manager->free_size * percent_input) / 100.0f);
+    MemSize large_size = (MemSize)(manager->free_size * (double)percent_input / 100.0);
 
-    Process large_process;
-    large_process.id = 9999; // the largest process ID
-    large_process.size = large_size;
-    large_process.state = PROCESS_NEW;
-    large_process.block_index = -1;
+    // Built in the spare table slot so a queued request keeps a stable address
+    Process *large_process = &processes[*num_processes];
+    large_process->id = 9999; // the largest process ID
+    large_process->size = large_size;
+    large_process->state = PROCESS_NEW;
+    large_process->block_index = -1;
 
     stats->allocation_attempts++;
-    printf("Attempting large allocation (P9999, %dKB - %.2f%% of availablr free memory): ", large_process.size, percent_input);
+    printf("Attempting large allocation (P9999, %lld%s - %.2f%% of availablr free memory): ",
+           large_process->size, get_unit_name(), percent_input);
 
-    if (allocate_memory(manager, &large_process))
+    if (admit_request(manager, large_process))
     {
         stats->successful_allocations++;
         printf("SUCCESS\n");
-        processes[num_processes] = large_process;
-        num_processes++;
     }
     else
     {
         stats->failed_allocations++;
-        printf("FAILED (not enough contiguous space)\n");
+        printf(large_process->state == PROCESS_WAITING ? "WAITING (queued, not enough contiguous space)\n"
+                                                       : "FAILED (not enough contiguous space)\n");
     }
-
-    current_utilization = (double)(manager->total_size - manager->free_size) / manager->total_size;
-    total_utilization += current_utilization;
-    utilization_samples++;
-    if (current_utilization > stats->peak_utilization)
+    if (large_process->state != PROCESS_NEW)
     {
-        stats->peak_utilization = current_utilization;
+        (*num_processes)++;
+        manager->process_count = *num_processes;
     }
 
-    if (utilization_samples > 0)
+    record_utilization(manager, stats);
+    if (stats->utilization_samples > 0)
     {
-        stats->avg_utilization = total_utilization / utilization_samples;
+        stats->avg_utilization = stats->utilization_sum / stats->utilization_samples;
     }
 
-    update_fragmentation_metrics(manager, processes, num_processes, stats);
-    print_memory_state_simplified(manager, processes, num_processes);
+    update_fragmentation_metrics(manager, processes, *num_processes, stats);
+    print_memory_state_simplified(manager, processes, *num_processes);
+}
 
+/**
+ * Print the final memory state and results block for one simulation
+ */
+void print_final_results(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats)
+{
     printf("\n--- Final Memory State (Detailed) ---\n");
     print_memory_state_detailed(manager, processes, num_processes);
 
     // Final statistics for this simulation
-    printf("\n--- Final Results (%s) ---\n",
-           strategy == FIRST_FIT ? "First-Fit" : (strategy == BEST_FIT ? "Best-Fit" : "Worst-Fit"));
+    printf("\n--- Final Results (%s) ---\n", get_manager_name(manager));
 
     printf("Success Rate: %.1f%% (%d/%d)\n",
            ((double)stats->successful_allocations / stats->allocation_attempts) * 100.0,
            stats->successful_allocations, stats->allocation_attempts);
     printf("Peak Memory Usage: %.1f%%\n", stats->peak_utilization * 100.0);
     printf("Fragmentation: %.1f%%\n", stats->fragmentation_percentage);
+    printf("Internal Fragmentation: %lld %s (%lld %s padding, %lld %s unsplit slack)\n",
+           stats->internal_fragmentation, get_unit_name(),
+           stats->padding_fragmentation, get_unit_name(),
+           stats->slack_fragmentation, get_unit_name());
     printf("Final Block Count: %d\n", manager->block_count);
+    printf("Coalescing (%s): %d merges, %d deferred, %d quick reuses, %d unmerged free blocks\n",
+           get_coalesce_policy_name(manager->coalesce_policy),
+           stats->merge_count, stats->deferred_merges, stats->quick_reuse_hits, stats->unmerged_free_blocks);
 
-    printf("\n--- %s Simulation Completed ---\n",
-           strategy == FIRST_FIT ? "First-Fit" : (strategy == BEST_FIT ? "Best-Fit" : "Worst-Fit"));
-    printf("\n\n****************************************************************************************************************************\n\n");
+    if (manager->queue != NULL)
+    {
+        print_queue_report(manager->queue);
+    }
+    if (manager->swap != NULL)
+    {
+        print_swap_report(manager->swap);
+    }
+    if (manager->adaptive != NULL)
+    {
+        print_adaptive_report(manager);
+    }
+    if (manager->latency != NULL)
+    {
+        print_latency_report(manager->latency);
+    }
+}
+
+/**
+ * Run phases 2-4 and print the final results
+ */
+void run_remaining_phases(MemoryManager *manager, Process processes[], int *num_processes, Statistics *stats)
+{
+    run_termination_phase(manager, processes, *num_processes, stats);
+    run_additional_allocation_phase(manager, processes, *num_processes, stats);
+    run_large_allocation_phase(manager, processes, num_processes, stats);
+    print_final_results(manager, processes, *num_processes, stats);
+}
+
+/**
+ * Continue several what-if branches from the state reached after phase 1
+ *
+ * The warmed-up state is captured once and every branch restores a full copy
+ * of it, so no branch has to replay phase 1.
+ */
+void run_branches(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats)
+{
+    SimulationSnapshot *warm_state = snapshot_create(manager, processes, num_processes, stats);
+    Statistics branch_stats[MAX_BRANCHES];
+    int branch_blocks[MAX_BRANCHES];
+
+    for (int b = 0; b < sim_options.branch_count; b++)
+    {
+        SimulationSnapshot *branch = snapshot_fork(warm_state);
+        int branch_processes = num_processes;
+
+        printf("\n##### Branch %d of %d (%s) #####\n", b + 1, sim_options.branch_count, get_manager_name(manager));
+        snapshot_restore(branch, manager, processes, &branch_processes, stats);
+        snapshot_release(branch);
+
+        run_remaining_phases(manager, processes, &branch_processes, stats);
+        branch_stats[b] = *stats;
+        branch_blocks[b] = manager->block_count;
+    }
+    snapshot_release(warm_state);
+
+    printf("\n--- Branch Comparison (%s) ---\n", get_manager_name(manager));
+    printf("%-8s %-15s %-15s %-15s\n", "Branch", "Success Rate", "Fragmentation", "Block Count");
+    printf("----------------------------------------------------------\n");
+    for (int b = 0; b < sim_options.branch_count; b++)
+    {
+        char success_str[20], frag_str[20];
+        sprintf(success_str, "%.1f%%", (double)branch_stats[b].successful_allocations / branch_stats[b].allocation_attempts * 100.0);
+        sprintf(frag_str, "%.1f%%", branch_stats[b].fragmentation_percentage);
+        printf("%-8d %-15s %-15s %-15d\n", b + 1, success_str, frag_str, branch_blocks[b]);
+    }
+
+    // The summary table reports the first branch
+    *stats = branch_stats[0];
+}
+
+/**
+ * Run a simulation with the specified allocation strategy
+ */
+void run_simulation(MemoryManager *manager, AllocationStrategy strategy,
+                    Process processes[], int num_processes, Statistics *stats)
+{
+    // Initialize statistics
+    memset(stats, 0, sizeof(Statistics));
+
+    // Keep process block indices in sync as blocks are split and merged
+    manager->process_table = processes;
+    manager->process_count = num_processes;
+
+    // Print allocation strategy
+    printf("\n=== %s Strategy Simulation ===\n", get_manager_name(manager));
+
+    // Snapshot records are keyed by strategy, which an adaptive run does not have
+    bool use_snapshots = manager->adaptive == NULL;
+
+    // --- Phase 1: Initial Process Allocation (or a restored snapshot) ---
+    SimulationSnapshot *restored = NULL;
+    if (use_snapshots && sim_options.load_snapshot_file != NULL)
+    {
+        restored = snapshot_load(sim_options.load_snapshot_file, strategy);
+    }
+
+    if (restored != NULL && snapshot_restore(restored, manager, processes, &num_processes, stats))
+    {
+        printf("\n--- Phase 1: Restored from snapshot '%s' ---\n", sim_options.load_snapshot_file);
+        print_memory_state_simplified(manager, processes, num_processes);
+    }
+    else
+    {
+        if (use_snapshots && sim_options.load_snapshot_file != NULL)
+        {
+            fprintf(stderr, "Warning: No usable %s snapshot in '%s', running phase 1\n",
+                    get_strategy_name(strategy), sim_options.load_snapshot_file);
+        }
+        run_initial_allocation_phase(manager, processes, num_processes, stats);
+    }
+    snapshot_release(restored);
+
+    if (use_snapshots && sim_options.save_snapshot_file != NULL)
+    {
+        SimulationSnapshot *snapshot = snapshot_create(manager, processes, num_processes, stats);
+        if (snapshot_append_to_file(snapshot, sim_options.save_snapshot_file))
+        {
+            printf("Saved %s snapshot (%zu bytes) to '%s'\n",
+                   get_strategy_name(strategy), snapshot->size, sim_options.save_snapshot_file);
+        }
+        snapshot_release(snapshot);
+    }
+
+    // --- Phases 2-4, once or per what-if branch ---
+    if (sim_options.branch_count > 1)
+    {
+        run_branches(manager, processes, num_processes, stats);
+    }
+    else
+    {
+        run_remaining_phases(manager, processes, &num_processes, stats);
+    }
+
+    printf("\n--- %s Simulation Completed ---\n", get_manager_name(manager));
+    printf("\n\n****************************************************************************************************************************\n\n");
+}
+
+/**
+ * Append a little-endian 32-bit integer to a snapshot buffer
+ */
+static unsigned char *put_int32(unsigned char *cursor, int32_t value)
+{
+    uint32_t bits = (uint32_t)value;
+    for (int i = 0; i < 4; i++)
+    {
+        cursor[i] = (unsigned char)(bits >> (8 * i));
+    }
+    return cursor + 4;
+}
+
+/**
+ * Read a little-endian 32-bit integer from a snapshot buffer
+ */
+static const unsigned char *get_int32(const unsigned char *cursor, int32_t *value)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        bits |= (uint32_t)cursor[i] << (8 * i);
+    }
+    *value = (int32_t)bits;
+    return cursor + 4;
+}
+
+/**
+ * Append a little-endian 64-bit integer to a snapshot buffer
+ */
+static unsigned char *put_int64(unsigned char *cursor, MemSize value)
+{
+    uint64_t bits = (uint64_t)value;
+    for (int i = 0; i < 8; i++)
+    {
+        cursor[i] = (unsigned char)(bits >> (8 * i));
+    }
+    return cursor + 8;
+}
+
+/**
+ * Read a little-endian 64-bit integer from a snapshot buffer
+ */
+static const unsigned char *get_int64(const unsigned char *cursor, MemSize *value)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        bits |= (uint64_t)cursor[i] << (8 * i);
+    }
+    *value = (MemSize)bits;
+    return cursor + 8;
+}
+
+/**
+ * Append a double to a snapshot buffer, as its IEEE 754 bits in little-endian order
+ */
+static unsigned char *put_double(unsigned char *cursor, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put_int64(cursor, (MemSize)bits);
+}
+
+/**
+ * Read a double written by put_double
+ */
+static const unsigned char *get_double(const unsigned char *cursor, double *value)
+{
+    MemSize bits;
+    cursor = get_int64(cursor, &bits);
+    uint64_t raw = (uint64_t)bits;
+    memcpy(value, &raw, sizeof(raw));
+    return cursor;
+}
+
+/**
+ * Serialize a memory manager, its process table and statistics
+ *
+ * Layout: "MSNP", version, record size, manager fields (merge counters
+ * included), statistics fields, then block_count blocks (start, size, free flag) and num_processes
+ * processes (id, size, block index, state). Only used entries are stored.
+ */
+SimulationSnapshot *snapshot_create(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats)
+{
+    size_t size = SNAPSHOT_HEADER_SIZE +
+                  (size_t)manager->block_count * SNAPSHOT_BLOCK_SIZE +
+                  (size_t)num_processes * SNAPSHOT_PROCESS_SIZE;
+
+    SimulationSnapshot *snapshot = malloc(sizeof(SimulationSnapshot));
+    unsigned char *data = malloc(size);
+    if (snapshot == NULL || data == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate snapshot\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned char *cursor = data;
+    memcpy(cursor, SNAPSHOT_MAGIC, 4);
+    cursor += 4;
+    cursor = put_int32(cursor, SNAPSHOT_VERSION);
+    cursor = put_int32(cursor, (int32_t)size);
+    cursor = put_int32(cursor, manager->strategy);
+    cursor = put_int64(cursor, manager->total_size);
+    cursor = put_int64(cursor, manager->free_size);
+    cursor = put_int64(cursor, manager->internal_fragmentation);
+    cursor = put_int32(cursor, manager->block_count);
+    cursor = put_int32(cursor, num_processes);
+    cursor = put_int32(cursor, manager->merge_count);
+    cursor = put_int32(cursor, manager->deferred_merges);
+    cursor = put_int32(cursor, manager->quick_reuse_hits);
+    cursor = put_int32(cursor, stats->allocation_attempts);
+    cursor = put_int32(cursor, stats->successful_allocations);
+    cursor = put_int32(cursor, stats->failed_allocations);
+    cursor = put_int32(cursor, stats->utilization_samples);
+    cursor = put_double(cursor, stats->peak_utilization);
+    cursor = put_double(cursor, stats->utilization_sum);
+
+    for (int i = 0; i < manager->block_count; i++)
+    {
+        cursor = put_int64(cursor, manager->blocks[i].start_address);
+        cursor = put_int64(cursor, get_block_size(&manager->blocks[i]));
+        *cursor++ = is_block_free(&manager->blocks[i]) ? 1 : 0;
+    }
+
+    for (int i = 0; i < num_processes; i++)
+    {
+        cursor = put_int32(cursor, processes[i].id);
+        cursor = put_int64(cursor, processes[i].size);
+        cursor = put_int32(cursor, processes[i].block_index);
+        *cursor++ = (unsigned char)processes[i].state;
+    }
+
+    snapshot->data = data;
+    snapshot->size = size;
+    snapshot->ref_count = 1;
+    return snapshot;
+}
+
+/**
+ * Fork a snapshot
+ *
+ * Forks are reference counted, not copy-on-write: they share the read-only
+ * serialized state, and every branch restores all of it into the manager.
+ */
+SimulationSnapshot *snapshot_fork(SimulationSnapshot *snapshot)
+{
+    snapshot->ref_count++;
+    return snapshot;
+}
+
+/**
+ * Drop a reference to a snapshot, freeing it with the last reference
+ */
+void snapshot_release(SimulationSnapshot *snapshot)
+{
+    if (snapshot == NULL || --snapshot->ref_count > 0)
+    {
+        return;
+    }
+    free(snapshot->data);
+    free(snapshot);
+}
+
+/**
+ * Restore a snapshot into a memory manager and process table
+ *
+ * The manager keeps its process_table and verbose settings; everything else,
+ * including the page bitmap, is rebuilt from the snapshot. On entry
+ * *num_processes is the capacity of processes; snapshots with more processes
+ * are rejected.
+ *
+ * Returns:
+ *   true on success, false if the snapshot is malformed
+ */
+bool snapshot_restore(const SimulationSnapshot *snapshot, MemoryManager *manager,
+                      Process processes[], int *num_processes, Statistics *stats)
+{
+    const unsigned char *cursor = snapshot->data;
+    int32_t version, size, strategy, block_count, process_count;
+    int32_t merge_count, deferred_merges, quick_reuse_hits;
+    MemSize total_size, free_size, internal_fragmentation;
+
+    if (snapshot->size < SNAPSHOT_HEADER_SIZE || memcmp(cursor, SNAPSHOT_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+    cursor += 4;
+    cursor = get_int32(cursor, &version);
+    cursor = get_int32(cursor, &size);
+    cursor = get_int32(cursor, &strategy);
+    cursor = get_int64(cursor, &total_size);
+    cursor = get_int64(cursor, &free_size);
+    cursor = get_int64(cursor, &internal_fragmentation);
+    cursor = get_int32(cursor, &block_count);
+    cursor = get_int32(cursor, &process_count);
+    cursor = get_int32(cursor, &merge_count);
+    cursor = get_int32(cursor, &deferred_merges);
+    cursor = get_int32(cursor, &quick_reuse_hits);
+
+    if (version != SNAPSHOT_VERSION || (size_t)size != snapshot->size ||
+        block_count < 1 ||
+        process_count < 0 || process_count > *num_processes ||
+        (size_t)size != SNAPSHOT_HEADER_SIZE + (size_t)block_count * SNAPSHOT_BLOCK_SIZE +
+                            (size_t)process_count * SNAPSHOT_PROCESS_SIZE ||
+        strategy < FIRST_FIT || strategy > BITMAP_FIT || total_size < 1 ||
+        merge_count < 0 || deferred_merges < 0 || quick_reuse_hits < 0)
+    {
+        return false;
+    }
+
+    // Validate the blocks and processes before anything is overwritten: blocks
+    // must tile [0, total_size) and every block index must name a used block
+    const unsigned char *check = cursor + 4 * 4 + 2 * 8;
+    MemSize next_address = 0, free_total = 0;
+    for (int i = 0; i < block_count; i++)
+    {
+        MemSize start_address, block_size;
+        check = get_int64(check, &start_address);
+        check = get_int64(check, &block_size);
+        bool is_free = *check++ != 0;
+
+        if (start_address != next_address || block_size < 1 || block_size > total_size - start_address)
+        {
+            return false;
+        }
+        next_address += block_size;
+        if (is_free)
+            free_total += block_size;
+    }
+    if (next_address != total_size || free_total != free_size)
+    {
+        return false;
+    }
+    const unsigned char *blocks_data = cursor + 4 * 4 + 2 * 8;
+    for (int i = 0; i < process_count; i++)
+    {
+        int32_t id, block_index;
+        MemSize process_size;
+        check = get_int32(check, &id);
+        check = get_int64(check, &process_size);
+        check = get_int32(check, &block_index);
+        int state = *check++;
+
+        if (block_index < -1 || block_index >= block_count || process_size < 0 || state > PROCESS_SWAPPED ||
+            (block_index >= 0 && blocks_data[(size_t)block_index * SNAPSHOT_BLOCK_SIZE + SNAPSHOT_BLOCK_SIZE - 1] != 0))
+        {
+            return false;
+        }
+    }
+
+    memset(stats, 0, sizeof(Statistics));
+    cursor = get_int32(cursor, &stats->allocation_attempts);
+    cursor = get_int32(cursor, &stats->successful_allocations);
+    cursor = get_int32(cursor, &stats->failed_allocations);
+    cursor = get_int32(cursor, &stats->utilization_samples);
+    cursor = get_double(cursor, &stats->peak_utilization);
+    cursor = get_double(cursor, &stats->utilization_sum);
+
+    if (!reserve_blocks(manager, block_count))
+    {
+        fprintf(stderr, "Error: Could not allocate block array\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bitmap_destroy(manager->bitmap);
+    manager->bitmap = NULL;
+    manager->strategy = (AllocationStrategy)strategy;
+    manager->total_size = total_size;
+    manager->free_size = free_size;
+    manager->internal_fragmentation = internal_fragmentation;
+    manager->block_count = block_count;
+    manager->reuse_count = 0;
+    manager->pending_frees = 0;
+    manager->merge_count = merge_count;
+    manager->deferred_merges = deferred_merges;
+    manager->quick_reuse_hits = quick_reuse_hits;
+
+    // Latencies are not stored; a restored run measures only its own operations
+    if (manager->latency != NULL)
+    {
+        memset(manager->latency, 0, sizeof(LatencyRecorder));
+    }
+
+    for (int i = 0; i < block_count; i++)
+    {
+        MemSize block_size;
+        cursor = get_int64(cursor, &manager->blocks[i].start_address);
+        cursor = get_int64(cursor, &block_size);
+        set_block(&manager->blocks[i], block_size, *cursor++ != 0);
+    }
+
+    for (int i = 0; i < process_count; i++)
+    {
+        cursor = get_int32(cursor, &processes[i].id);
+        cursor = get_int64(cursor, &processes[i].size);
+        cursor = get_int32(cursor, &processes[i].block_index);
+        processes[i].state = (ProcessState)*cursor++;
+    }
+    *num_processes = process_count;
+    manager->process_count = process_count;
+
+    if (manager->strategy == BITMAP_FIT)
+    {
+        manager->bitmap = bitmap_create(manager->total_size);
+    }
+    align_to_pages(manager);
+    if (manager->bitmap != NULL)
+    {
+        for (int i = 0; i < block_count; i++)
+        {
+            if (!is_block_free(&manager->blocks[i]))
+                bitmap_mark_block(manager, i, true);
+        }
+    }
+
+    // The breakdown is not stored; recompute it from the placed processes
+    manager->padding_fragmentation = 0;
+    for (int i = 0; i < process_count; i++)
+    {
+        if (processes[i].block_index >= 0 && processes[i].block_index < block_count)
+            manager->padding_fragmentation += round_request_size(manager, processes[i].size) - processes[i].size;
+    }
+    manager->slack_fragmentation = manager->internal_fragmentation - manager->padding_fragmentation;
+
+    if (manager->queue != NULL)
+    {
+        queue_reset(manager, processes, process_count);
+    }
+    if (manager->swap != NULL)
+    {
+        swap_reset(manager, processes, process_count);
+    }
+
+    if (manager->adaptive != NULL)
+    {
+        adaptive_sync(manager);
+    }
+
+    return true;
+}
+
+/**
+ * Append a snapshot record to a file
+ */
+bool snapshot_append_to_file(const SimulationSnapshot *snapshot, const char *filename)
+{
+    FILE *file = fopen(filename, "ab");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: Could not open snapshot file '%s'\n", filename);
+        return false;
+    }
+
+    bool ok = fwrite(snapshot->data, 1, snapshot->size, file) == snapshot->size;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "Error: Could not write snapshot file '%s'\n", filename);
+    }
+    return ok;
+}
+
+/**
+ * Load the snapshot record for a strategy from a file
+ *
+ * Returns:
+ *   The snapshot, or NULL if the file has no record for that strategy
+ */
+SimulationSnapshot *snapshot_load(const char *filename, AllocationStrategy strategy)
+{
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: Could not open snapshot file '%s'\n", filename);
+        return NULL;
+    }
+
+    unsigned char header[16];
+    while (fread(header, 1, sizeof(header), file) == sizeof(header))
+    {
+        int32_t version, size, record_strategy;
+        get_int32(header + 4, &version);
+        get_int32(header + 8, &size);
+        get_int32(header + 12, &record_strategy);
+
+        if (memcmp(header, SNAPSHOT_MAGIC, 4) != 0 || size < (int32_t)sizeof(header))
+        {
+            break;
+        }
+
+        if (record_strategy != (int32_t)strategy)
+        {
+            fseek(file, size - (long)sizeof(header), SEEK_CUR);
+            continue;
+        }
+
+        SimulationSnapshot *snapshot = malloc(sizeof(SimulationSnapshot));
+        unsigned char *data = malloc(size);
+        if (snapshot == NULL || data == NULL)
+        {
+            fprintf(stderr, "Error: Could not allocate snapshot\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(data, header, sizeof(header));
+        if (fread(data + sizeof(header), 1, size - sizeof(header), file) != size - sizeof(header))
+        {
+            free(data);
+            free(snapshot);
+            break;
+        }
+
+        fclose(file);
+        snapshot->data = data;
+        snapshot->size = size;
+        snapshot->ref_count = 1;
+        return snapshot;
+    }
+
+    fclose(file);
+    return NULL;
+}
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * printf for verbose output issued inside a timed region
+ *
+ * The time spent printing is added to manager->untimed_ns, which the timed
+ * regions subtract from their own measurement.
+ */
+void log_untimed(MemoryManager *manager, const char *format, ...)
+{
+    bool timed = manager->latency != NULL || manager->adaptive != NULL;
+    long long start = timed ? now_ns() : 0;
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    if (timed)
+    {
+        manager->untimed_ns += now_ns() - start;
+    }
+}
+
+/**
+ * Create adaptive state for a primary manager
+ *
+ * One shadow manager per block-list fit (First, Best, Worst) replays every
+ * allocation and deallocation the primary sees. Bitmap Fit is not a candidate
+ * because its page rounding cannot be switched on for blocks placed earlier.
+ */
+AdaptiveState *adaptive_create(MemoryManager *manager)
+{
+    AdaptiveState *adaptive = calloc(1, sizeof(AdaptiveState));
+    if (adaptive == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate adaptive state\n");
+        exit(EXIT_FAILURE);
+    }
+
+    manager->adaptive = adaptive;
+    adaptive_sync(manager);
+    return adaptive;
+}
+
+/**
+ * Free adaptive state
+ */
+void adaptive_destroy(AdaptiveState *adaptive)
+{
+    if (adaptive == NULL)
+    {
+        return;
+    }
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        free(adaptive->shadows[c].manager.blocks);
+        free(adaptive->shadows[c].processes);
+    }
+    free(adaptive);
+}
+
+/**
+ * Make room for count processes in a shadow's table
+ */
+static void shadow_reserve_processes(ShadowManager *shadow, int count)
+{
+    if (count > shadow->process_capacity)
+    {
+        int capacity = shadow->process_capacity > 0 ? shadow->process_capacity : INITIAL_PROCESS_CAPACITY;
+        while (capacity < count)
+            capacity *= 2;
+
+        Process *processes = realloc(shadow->processes, sizeof(Process) * (size_t)capacity);
+        if (processes == NULL)
+        {
+            fprintf(stderr, "Error: Could not allocate shadow process table\n");
+            exit(EXIT_FAILURE);
+        }
+        shadow->processes = processes;
+        shadow->process_capacity = capacity;
+    }
+    shadow->manager.process_table = shadow->processes;
+}
+
+/**
+ * Reset every shadow to a copy of the primary's current state
+ *
+ * Called on attach and whenever the primary is restored from a snapshot.
+ */
+void adaptive_sync(MemoryManager *manager)
+{
+    AdaptiveState *adaptive = manager->adaptive;
+
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        ShadowManager *shadow = &adaptive->shadows[c];
+        MemoryBlock *blocks = shadow->manager.blocks;
+        int block_capacity = shadow->manager.block_capacity;
+
+        shadow->manager = *manager;
+        shadow->manager.blocks = blocks;
+        shadow->manager.block_capacity = block_capacity;
+        copy_blocks(&shadow->manager, manager);
+        shadow->manager.strategy = (AllocationStrategy)c;
+        shadow->manager.bitmap = NULL;
+        shadow->manager.adaptive = NULL;
+        shadow->manager.latency = NULL;
+        shadow->manager.queue = NULL;
+        shadow->manager.lifetime = NULL;
+        shadow->manager.swap = NULL;
+        shadow->manager.verbose = false;
+        shadow_reserve_processes(shadow, manager->process_count + 1);
+        memcpy(shadow->processes, manager->process_table, sizeof(Process) * manager->process_count);
+        shadow->total_failures = 0;
+    }
+
+    adaptive->window_fill = 0;
+    adaptive->window_pos = 0;
+    adaptive->leader = -1;
+    adaptive->lead_streak = 0;
+}
+
+/**
+ * Find a process in a shadow's table by ID
+ */
+static Process *shadow_find_process(ShadowManager *shadow, int id)
+{
+    for (int i = 0; i < shadow->manager.process_count; i++)
+    {
+        if (shadow->processes[i].id == id)
+            return &shadow->processes[i];
+    }
+    return NULL;
+}
+
+/**
+ * Push the outcome of one event for every shadow into the sliding window
+ */
+static void adaptive_push_window(AdaptiveState *adaptive, const bool failed[])
+{
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        ShadowManager *shadow = &adaptive->shadows[c];
+        Statistics metrics;
+
+        update_fragmentation_metrics(&shadow->manager, shadow->processes, shadow->manager.process_count, &metrics);
+        shadow->window_failed[adaptive->window_pos] = failed[c];
+        shadow->window_fragmentation[adaptive->window_pos] = metrics.fragmentation_percentage;
+    }
+
+    adaptive->window_pos = (adaptive->window_pos + 1) % ADAPTIVE_WINDOW;
+    if (adaptive->window_fill < ADAPTIVE_WINDOW)
+        adaptive->window_fill++;
+    adaptive->event_count++;
+}
+
+/**
+ * Replay an allocation into every shadow, then re-evaluate the strategy
+ */
+void adaptive_record_allocation(MemoryManager *manager, Process *process)
+{
+    AdaptiveState *adaptive = manager->adaptive;
+    bool failed[ADAPTIVE_CANDIDATES];
+    long long start = now_ns();
+
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        ShadowManager *shadow = &adaptive->shadows[c];
+        Process *copy = shadow_find_process(shadow, process->id);
+
+        // Processes outside the table (the phase 4 large process) are appended
+        if (copy == NULL)
+        {
+            shadow_reserve_processes(shadow, shadow->manager.process_count + 1);
+            copy = &shadow->processes[shadow->manager.process_count++];
+            *copy = *process;
+            copy->state = PROCESS_NEW;
+            copy->block_index = -1;
+        }
+
+        failed[c] = false;
+        if (copy != NULL && copy->state != PROCESS_RUNNING)
+        {
+            copy->size = process->size;
+            failed[c] = !place_process(&shadow->manager, copy);
+            if (failed[c])
+                shadow->total_failures++;
+        }
+    }
+
+    adaptive_push_window(adaptive, failed);
+    adaptive->shadow_ns += now_ns() - start;
+
+    adaptive_evaluate(manager);
+}
+
+/**
+ * Replay a deallocation into every shadow
+ */
+void adaptive_record_deallocation(MemoryManager *manager, Process *process)
+{
+    AdaptiveState *adaptive = manager->adaptive;
+    bool failed[ADAPTIVE_CANDIDATES] = {false};
+    long long start = now_ns();
+
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        ShadowManager *shadow = &adaptive->shadows[c];
+        Process *copy = shadow_find_process(shadow, process->id);
+
+        if (copy != NULL && copy->state == PROCESS_RUNNING)
+        {
+            release_process(&shadow->manager, copy);
+        }
+    }
+
+    adaptive_push_window(adaptive, failed);
+    adaptive->shadow_ns += now_ns() - start;
+
+    adaptive_evaluate(manager);
+}
+
+/**
+ * Switch the primary's strategy if another shadow keeps doing better
+ *
+ * A shadow beats the current strategy's shadow when it had fewer failures
+ * over the window, or as many failures and at least ADAPTIVE_FRAG_MARGIN
+ * points less average fragmentation. The same shadow has to win
+ * ADAPTIVE_PATIENCE evaluations in a row before the primary switches.
+ */
+void adaptive_evaluate(MemoryManager *manager)
+{
+    AdaptiveState *adaptive = manager->adaptive;
+    int failures[ADAPTIVE_CANDIDATES];
+    double fragmentation[ADAPTIVE_CANDIDATES];
+
+    if (manager->strategy >= ADAPTIVE_CANDIDATES || adaptive->window_fill == 0)
+    {
+        return;
+    }
+
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        failures[c] = 0;
+        fragmentation[c] = 0.0;
+        for (int w = 0; w < adaptive->window_fill; w++)
+        {
+            failures[c] += adaptive->shadows[c].window_failed[w];
+            fragmentation[c] += adaptive->shadows[c].window_fragmentation[w];
+        }
+        fragmentation[c] /= adaptive->window_fill;
+    }
+
+    int current = manager->strategy;
+    int best = current;
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        if (failures[c] < failures[best] ||
+            (failures[c] == failures[best] && fragmentation[c] + ADAPTIVE_FRAG_MARGIN <= fragmentation[best]))
+        {
+            best = c;
+        }
+    }
+
+    if (best == current)
+    {
+        adaptive->leader = -1;
+        adaptive->lead_streak = 0;
+        return;
+    }
+
+    if (best != adaptive->leader)
+    {
+        adaptive->leader = best;
+        adaptive->lead_streak = 0;
+    }
+
+    if (++adaptive->lead_streak < ADAPTIVE_PATIENCE)
+    {
+        return;
+    }
+
+    if (adaptive->switch_count < MAX_SWITCH_LOG)
+    {
+        SwitchDecision *decision = &adaptive->switches[adaptive->switch_count];
+        decision->event = adaptive->event_count;
+        decision->from = (AllocationStrategy)current;
+        decision->to = (AllocationStrategy)best;
+        decision->from_failures = failures[current];
+        decision->to_failures = failures[best];
+        decision->from_fragmentation = fragmentation[current];
+        decision->to_fragmentation = fragmentation[best];
+    }
+    adaptive->switch_count++;
+
+    manager->strategy = (AllocationStrategy)best;
+    adaptive->leader = -1;
+    adaptive->lead_streak = 0;
+}
+
+/**
+ * Print the switch decisions and shadow overhead of an adaptive run
+ */
+void print_adaptive_report(MemoryManager *manager)
+{
+    AdaptiveState *adaptive = manager->adaptive;
+
+    printf("Final Strategy: %s\n", get_strategy_name(manager->strategy));
+    printf("Strategy Switches: %d\n", adaptive->switch_count);
+    for (int i = 0; i < adaptive->switch_count && i < MAX_SWITCH_LOG; i++)
+    {
+        SwitchDecision *decision = &adaptive->switches[i];
+        printf("  event %-4d %s -> %s (window failures %d vs %d, fragmentation %.1f%% vs %.1f%%)\n",
+               decision->event,
+               get_strategy_name(decision->from),
+               get_strategy_name(decision->to),
+               decision->from_failures, decision->to_failures,
+               decision->from_fragmentation, decision->to_fragmentation);
+    }
+
+    printf("Shadow Results:");
+    for (int c = 0; c < ADAPTIVE_CANDIDATES; c++)
+    {
+        printf(" %s %d failed%s", get_strategy_name((AllocationStrategy)c),
+               adaptive->shadows[c].total_failures, c + 1 < ADAPTIVE_CANDIDATES ? "," : "\n");
+    }
+
+    printf("Shadow Overhead: %lld ns in shadows vs %lld ns in primary over %d events",
+           adaptive->shadow_ns, adaptive->primary_ns, adaptive->event_count);
+    if (adaptive->primary_ns > 0)
+        printf(" (%.1fx)", (double)adaptive->shadow_ns / adaptive->primary_ns);
+    printf("\n");
+}
+
+/**
+ * Create an empty latency recorder
+ */
+LatencyRecorder *latency_create(void)
+{
+    LatencyRecorder *recorder = calloc(1, sizeof(LatencyRecorder));
+    if (recorder == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate latency recorder\n");
+        exit(EXIT_FAILURE);
+    }
+    return recorder;
+}
+
+/**
+ * Free a latency recorder
+ */
+void latency_destroy(LatencyRecorder *recorder)
+{
+    free(recorder);
+}
+
+/**
+ * Map a value to its histogram bucket
+ *
+ * Values below LATENCY_SUB_BUCKETS get exact buckets; above that every power
+ * of two is split into LATENCY_SUB_BUCKETS / 2 linear sub-buckets.
+ */
+static int latency_bucket(uint64_t value)
+{
+    if (value < LATENCY_SUB_BUCKETS)
+    {
+        return (int)value;
+    }
+
+    int magnitude = 63 - __builtin_clzll(value);
+    int shift = magnitude - LATENCY_SUB_BITS + 1;
+    int sub_bucket = (int)(value >> shift) - LATENCY_SUB_BUCKETS / 2;
+    return LATENCY_SUB_BUCKETS + (shift - 1) * (LATENCY_SUB_BUCKETS / 2) + sub_bucket;
+}
+
+/**
+ * Largest value that maps to a histogram bucket
+ */
+static uint64_t latency_bucket_limit(int bucket)
+{
+    if (bucket < LATENCY_SUB_BUCKETS)
+    {
+        return (uint64_t)bucket;
+    }
+
+    int shift = (bucket - LATENCY_SUB_BUCKETS) / (LATENCY_SUB_BUCKETS / 2) + 1;
+    uint64_t sub_bucket = (bucket - LATENCY_SUB_BUCKETS) % (LATENCY_SUB_BUCKETS / 2) + LATENCY_SUB_BUCKETS / 2;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+/**
+ * Record one operation latency
+ */
+void latency_record(LatencyRecorder *recorder, OperationKind kind, long long nanoseconds)
+{
+    histogram_record(&recorder->histograms[kind], nanoseconds > 0 ? (uint64_t)nanoseconds : 0);
+}
+
+/**
+ * Add one sample to a histogram
+ */
+void histogram_record(LatencyHistogram *histogram, uint64_t value)
+{
+    histogram->counts[latency_bucket(value)]++;
+    histogram->total_count++;
+    if (value > histogram->max_value)
+    {
+        histogram->max_value = value;
+    }
+}
+
+/**
+ * Value at a percentile (0-100), accurate to the bucket width
+ */
+uint64_t latency_percentile(const LatencyHistogram *histogram, double percentile)
+{
+    if (histogram->total_count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * histogram->total_count + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        seen += histogram->counts[bucket];
+        if (seen >= rank)
+        {
+            uint64_t limit = latency_bucket_limit(bucket);
+            return limit < histogram->max_value ? limit : histogram->max_value;
+        }
+    }
+    return histogram->max_value;
+}
+
+/**
+ * Print p50/p99/p99.9/max for every operation kind that was recorded
+ */
+void print_latency_report(const LatencyRecorder *recorder)
+{
+    static const char *operation_names[NUM_OPERATION_KINDS] = {"allocate", "find", "coalesce", "deallocate"};
+
+    printf("Operation Latency (ns):\n");
+    printf("  %-12s %-10s %-10s %-10s %-10s %-10s\n", "Operation", "Count", "p50", "p99", "p99.9", "Max");
+    for (int kind = 0; kind < NUM_OPERATION_KINDS; kind++)
+    {
+        const LatencyHistogram *histogram = &recorder->histograms[kind];
+        if (histogram->total_count == 0)
+        {
+            continue;
+        }
+
+        printf("  %-12s %-10llu %-10llu %-10llu %-10llu %-10llu\n",
+               operation_names[kind],
+               (unsigned long long)histogram->total_count,
+               (unsigned long long)latency_percentile(histogram, 50.0),
+               (unsigned long long)latency_percentile(histogram, 99.0),
+               (unsigned long long)latency_percentile(histogram, 99.9),
+               (unsigned long long)histogram->max_value);
+    }
+}
+
+/**
+ * Get the display name of an admission queue policy
+ */
+const char *get_queue_policy_name(QueuePolicy policy)
+{
+    switch (policy)
+    {
+    case QUEUE_FIFO:
+        return "FIFO";
+    case QUEUE_SMALLEST_FIRST:
+        return "smallest-first";
+    case QUEUE_BEST_FIT:
+        return "best-fitting waiter";
+    default:
+        return "Unknown";
+    }
+}
+
+/**
+ * Create an empty admission queue
+ */
+AdmissionQueue *queue_create(QueuePolicy policy)
+{
+    AdmissionQueue *queue = calloc(1, sizeof(AdmissionQueue));
+    if (queue != NULL)
+    {
+        queue->entries = malloc(sizeof(QueueEntry) * QUEUE_INITIAL_CAPACITY);
+    }
+    if (queue == NULL || queue->entries == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate admission queue\n");
+        exit(EXIT_FAILURE);
+    }
+
+    queue->policy = policy;
+    queue->capacity = QUEUE_INITIAL_CAPACITY;
+    return queue;
+}
+
+/**
+ * Free an admission queue (NULL is allowed)
+ */
+void queue_destroy(AdmissionQueue *queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    free(queue->entries);
+    free(queue);
+}
+
+/**
+ * Advance the queue clock by one operation and sample the queue length
+ */
+void queue_tick(AdmissionQueue *queue)
+{
+    queue->clock++;
+    queue->length_sum += (uint64_t)queue->count;
+}
+
+/**
+ * Put a process that could not be placed at the back of the queue
+ */
+void queue_enqueue(MemoryManager *manager, Process *process)
+{
+    AdmissionQueue *queue = manager->queue;
+
+    if (queue->count == queue->capacity)
+    {
+        QueueEntry *entries = realloc(queue->entries, sizeof(QueueEntry) * (size_t)queue->capacity * 2);
+        if (entries == NULL)
+        {
+            fprintf(stderr, "Error: Could not grow admission queue\n");
+            exit(EXIT_FAILURE);
+        }
+        queue->entries = entries;
+        queue->capacity *= 2;
+    }
+
+    MemSize request = round_request_size(manager, process->size);
+    if (queue->count == 0 || request < queue->min_request)
+    {
+        queue->min_request = request;
+    }
+
+    queue->entries[queue->count].process = process;
+    queue->entries[queue->count].enqueued_at = queue->clock;
+    queue->count++;
+    process->state = PROCESS_WAITING;
+    process->block_index = -1;
+
+    queue->enqueued++;
+    if (queue->count > queue->max_length)
+    {
+        queue->max_length = queue->count;
+    }
+}
+
+/**
+ * Rebuild the queue from the waiting processes of a restored snapshot
+ *
+ * Snapshots do not store the queue, so its statistics start over and the
+ * waiters start waiting at the restore, in process table order.
+ */
+void queue_reset(MemoryManager *manager, Process processes[], int num_processes)
+{
+    AdmissionQueue *queue = manager->queue;
+    QueueEntry *entries = queue->entries;
+    int capacity = queue->capacity;
+    QueuePolicy policy = queue->policy;
+
+    memset(queue, 0, sizeof(AdmissionQueue));
+    queue->entries = entries;
+    queue->capacity = capacity;
+    queue->policy = policy;
+
+    for (int i = 0; i < num_processes; i++)
+    {
+        if (processes[i].state == PROCESS_WAITING)
+        {
+            queue_enqueue(manager, &processes[i]);
+        }
+    }
+}
+
+/**
+ * Place a new request, or queue it if it does not fit
+ *
+ * Without --queue this is allocate_memory. Under FIFO a new request may not
+ * overtake anyone already waiting, so it joins the back of a non-empty queue
+ * without trying.
+ */
+bool admit_request(MemoryManager *manager, Process *process)
+{
+    AdmissionQueue *queue = manager->queue;
+
+    if (queue == NULL)
+    {
+        return allocate_memory(manager, process);
+    }
+
+    queue_tick(queue);
+    if (!(queue->policy == QUEUE_FIFO && queue->count > 0) && allocate_memory(manager, process))
+    {
+        return true;
+    }
+
+    queue_enqueue(manager, process);
+    return false;
+}
+
+/**
+ * Largest run of adjacent free blocks inside [start, end)
+ *
+ * With deferred coalescing neighbouring free blocks may not be merged yet;
+ * allocate_memory merges them before giving up, so they count as one hole.
+ */
+MemSize largest_free_run(MemoryManager *manager, MemSize start, MemSize end)
+{
+    MemSize largest = 0, run = 0;
+
+    for (int i = find_block_containing(manager, start);
+         i < manager->block_count && manager->blocks[i].start_address < end; i++)
+    {
+        run = is_block_free(&manager->blocks[i]) ? run + get_block_size(&manager->blocks[i]) : 0;
+        if (run > largest)
+        {
+            largest = run;
+        }
+    }
+    return largest;
+}
+
+/**
+ * Choose the waiter to admit into a hole of the given size, or -1
+ */
+int queue_pick(MemoryManager *manager, MemSize hole)
+{
+    AdmissionQueue *queue = manager->queue;
+    int pick = -1;
+    MemSize pick_request = 0;
+
+    for (int i = 0; i < queue->count; i++)
+    {
+        MemSize request = round_request_size(manager, queue->entries[i].process->size);
+
+        if (queue->policy == QUEUE_FIFO)
+        {
+            // Only the head may go; if it does not fit, everyone waits
+            return request <= hole ? 0 : -1;
+        }
+        if (request > hole)
+        {
+            continue;
+        }
+
+        bool better = queue->policy == QUEUE_SMALLEST_FIRST ? request < pick_request : request > pick_request;
+        if (pick == -1 || better)
+        {
+            pick = i;
+            pick_request = request;
+        }
+    }
+    return pick;
+}
+
+/**
+ * Admit waiters into the hole left by a free
+ *
+ * Every waiter already failed against the rest of memory, and a free only
+ * grows the hole around the freed block, so only that hole is considered.
+ * When it is smaller than the smallest waiter (cached in min_request) the
+ * retry is skipped without touching the queue. The exception is FIFO: the
+ * waiters behind the head queued without trying, so once the head gets in
+ * the next head is tried against all of memory.
+ */
+void queue_retry(MemoryManager *manager, MemSize freed_address)
+{
+    AdmissionQueue *queue = manager->queue;
+
+    int first = find_block_containing(manager, freed_address);
+    int last = first;
+    while (first > 0 && is_block_free(&manager->blocks[first - 1]))
+        first--;
+    while (last + 1 < manager->block_count && is_block_free(&manager->blocks[last + 1]))
+        last++;
+
+    MemSize start = manager->blocks[first].start_address;
+    MemSize end = manager->blocks[last].start_address + get_block_size(&manager->blocks[last]);
+    MemSize hole = end - start;
+
+    if (hole < queue->min_request)
+    {
+        queue->skipped_retries++;
+        return;
+    }
+    queue->retries++;
+
+    while (queue->count > 0)
+    {
+        int pick = queue_pick(manager, hole);
+        if (pick == -1)
+        {
+            break;
+        }
+
+        QueueEntry entry = queue->entries[pick];
+        entry.process->state = PROCESS_NEW;
+        if (!allocate_memory(manager, entry.process))
+        {
+            entry.process->state = PROCESS_WAITING;
+            break;
+        }
+
+        uint64_t wait = queue->clock - entry.enqueued_at;
+        histogram_record(&queue->waits, wait);
+        queue->admitted++;
+        if (wait > QUEUE_STARVATION_WAIT)
+        {
+            queue->starved++;
+        }
+
+        memmove(&queue->entries[pick], &queue->entries[pick + 1], sizeof(QueueEntry) * (size_t)(queue->count - pick - 1));
+        queue->count--;
+
+        queue->min_request = 0;
+        for (int i = 0; i < queue->count; i++)
+        {
+            MemSize request = round_request_size(manager, queue->entries[i].process->size);
+            if (i == 0 || request < queue->min_request)
+                queue->min_request = request;
+        }
+
+        if (queue->policy == QUEUE_FIFO)
+        {
+            start = 0;
+            end = manager->total_size;
+        }
+        hole = largest_free_run(manager, start, end);
+    }
+}
+
+/**
+ * Print queue length, wait percentiles and starvation
+ */
+void print_queue_report(const AdmissionQueue *queue)
+{
+    int still_starving = 0;
+    for (int i = 0; i < queue->count; i++)
+    {
+        if (queue->clock - queue->entries[i].enqueued_at > QUEUE_STARVATION_WAIT)
+            still_starving++;
+    }
+    uint64_t oldest = queue->count > 0 ? queue->clock - queue->entries[0].enqueued_at : 0;
+
+    printf("Admission Queue (%s): %d waited, %d admitted, %d still waiting (oldest %llu ops)\n",
+           get_queue_policy_name(queue->policy), queue->enqueued, queue->admitted, queue->count,
+           (unsigned long long)oldest);
+    printf("  Queue length: avg %.2f, max %d\n",
+           queue->clock > 0 ? (double)queue->length_sum / queue->clock : 0.0, queue->max_length);
+    printf("  Wait (ops): p50 %llu, p90 %llu, p99 %llu, max %llu\n",
+           (unsigned long long)latency_percentile(&queue->waits, 50.0),
+           (unsigned long long)latency_percentile(&queue->waits, 90.0),
+           (unsigned long long)latency_percentile(&queue->waits, 99.0),
+           (unsigned long long)queue->waits.max_value);
+    printf("  Starved (> %d ops): %d admitted late, %d still waiting\n",
+           QUEUE_STARVATION_WAIT, queue->starved, still_starving);
+    printf("  Retries: %d frees retried waiters, %d skipped (hole smaller than every waiter)\n",
+           queue->retries, queue->skipped_retries);
+}
+
+/**
+ * Get the display name of a swap victim policy
+ */
+const char *get_swap_policy_name(SwapPolicy policy)
+{
+    switch (policy)
+    {
+    case SWAP_OLDEST:
+        return "Oldest";
+    case SWAP_LARGEST_FIRST:
+        return "Largest-First";
+    case SWAP_MIN_BYTES:
+        return "Min-Bytes";
+    default:
+        return "Unknown";
+    }
+}
+
+/**
+ * Create an empty backing store
+ */
+SwapSpace *swap_create(SwapPolicy policy)
+{
+    SwapSpace *swap = calloc(1, sizeof(SwapSpace));
+    if (swap == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate backing store\n");
+        exit(EXIT_FAILURE);
+    }
+
+    swap->swapped = malloc(sizeof(Process *) * SWAP_INITIAL_CAPACITY);
+    swap->holes = malloc(sizeof(SwapHole) * SWAP_INITIAL_CAPACITY);
+    swap->holes_by_size = malloc(sizeof(SwapHole) * SWAP_INITIAL_CAPACITY);
+    swap->resident = malloc(sizeof(Process *) * SWAP_INITIAL_CAPACITY);
+    swap->resident_by_size = malloc(sizeof(SwapResident) * SWAP_INITIAL_CAPACITY);
+    if (swap->swapped == NULL || swap->holes == NULL || swap->holes_by_size == NULL || swap->resident == NULL ||
+        swap->resident_by_size == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate backing store\n");
+        exit(EXIT_FAILURE);
+    }
+    swap->capacity = SWAP_INITIAL_CAPACITY;
+    swap->hole_capacity = SWAP_INITIAL_CAPACITY;
+    swap->resident_capacity = SWAP_INITIAL_CAPACITY;
+    swap->policy = policy;
+    return swap;
+}
+
+/**
+ * Free a backing store
+ */
+void swap_destroy(SwapSpace *swap)
+{
+    if (swap == NULL)
+    {
+        return;
+    }
+    free(swap->swapped);
+    free(swap->holes);
+    free(swap->holes_by_size);
+    free(swap->resident);
+    free(swap->resident_by_size);
+    free(swap->owner);
+    free(swap->queues);
+    free(swap);
+}
+
+/**
+ * Rebuild the backing store from the swapped processes of a restored snapshot
+ *
+ * Snapshots store neither the backing store nor placement times, so the
+ * statistics start over, swapped processes are listed in process table order
+ * and running processes count as placed in that order too.
+ */
+void swap_reset(MemoryManager *manager, Process processes[], int num_processes)
+{
+    SwapSpace *swap = manager->swap;
+    SwapSpace kept = *swap;
+
+    memset(swap, 0, sizeof(SwapSpace));
+    swap->policy = kept.policy;
+    swap->swapped = kept.swapped;
+    swap->capacity = kept.capacity;
+    swap->holes = kept.holes;
+    swap->holes_by_size = kept.holes_by_size;
+    swap->hole_capacity = kept.hole_capacity;
+    swap->resident = kept.resident;
+    swap->resident_by_size = kept.resident_by_size;
+    swap->resident_capacity = kept.resident_capacity;
+    swap->owner = kept.owner;
+    swap->queues = kept.queues;
+    swap->scratch_capacity = kept.scratch_capacity;
+
+    for (int i = 0; i < num_processes; i++)
+    {
+        if (processes[i].state == PROCESS_RUNNING)
+        {
+            processes[i].placed_at = ++swap->clock;
+        }
+        else if (processes[i].state == PROCESS_SWAPPED)
+        {
+            swap->swapped[swap->count++] = &processes[i];
+            swap->store_size += processes[i].size;
+        }
+    }
+    swap->peak_store_size = swap->store_size;
+    swap_index_rebuild(manager);
+}
+
+/**
+ * Grow both hole arrays to hold at least count holes
+ */
+static void swap_reserve_holes(SwapSpace *swap, int count)
+{
+    if (count <= swap->hole_capacity)
+    {
+        return;
+    }
+
+    int capacity = swap->hole_capacity * 2;
+    SwapHole *holes = realloc(swap->holes, sizeof(SwapHole) * (size_t)capacity);
+    if (holes == NULL)
+    {
+        fprintf(stderr, "Error: Could not grow swap hole index\n");
+        exit(EXIT_FAILURE);
+    }
+    swap->holes = holes;
+    holes = realloc(swap->holes_by_size, sizeof(SwapHole) * (size_t)capacity);
+    if (holes == NULL)
+    {
+        fprintf(stderr, "Error: Could not grow swap hole index\n");
+        exit(EXIT_FAILURE);
+    }
+    swap->holes_by_size = holes;
+    swap->hole_capacity = capacity;
+}
+
+/**
+ * Grow both resident arrays to hold at least count processes
+ */
+static void swap_reserve_resident(SwapSpace *swap, int count)
+{
+    if (count <= swap->resident_capacity)
+    {
+        return;
+    }
+
+    int capacity = swap->resident_capacity * 2;
+    Process **resident = realloc(swap->resident, sizeof(Process *) * (size_t)capacity);
+    if (resident == NULL)
+    {
+        fprintf(stderr, "Error: Could not grow swap resident index\n");
+        exit(EXIT_FAILURE);
+    }
+    swap->resident = resident;
+    SwapResident *by_size = realloc(swap->resident_by_size, sizeof(SwapResident) * (size_t)capacity);
+    if (by_size == NULL)
+    {
+        fprintf(stderr, "Error: Could not grow swap resident index\n");
+        exit(EXIT_FAILURE);
+    }
+    swap->resident_by_size = by_size;
+    swap->resident_capacity = capacity;
+}
+
+/**
+ * Grow the scratch arrays of swap_out_for to cover count blocks
+ *
+ * They are kept between calls and only grow, so a swap-out allocates nothing
+ * once the block list has stopped growing.
+ */
+static void swap_reserve_scratch(SwapSpace *swap, int count)
+{
+    if (count <= swap->scratch_capacity)
+    {
+        return;
+    }
+
+    int capacity = swap->scratch_capacity * 2 > count ? swap->scratch_capacity * 2 : count;
+    Process **owner = realloc(swap->owner, sizeof(Process *) * (size_t)capacity);
+    if (owner == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate swap windows\n");
+        exit(EXIT_FAILURE);
+    }
+    swap->owner = owner;
+    int *queues = realloc(swap->queues, sizeof(int) * 2 * (size_t)capacity);
+    if (queues == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate swap windows\n");
+        exit(EXIT_FAILURE);
+    }
+    swap->queues = queues;
+    swap->scratch_capacity = capacity;
+}
+
+/**
+ * qsort comparator: holes by size, then address
+ */
+static int compare_swap_holes(const void *a, const void *b)
+{
+    const SwapHole *x = (const SwapHole *)a;
+    const SwapHole *y = (const SwapHole *)b;
+
+    if (x->size != y->size)
+        return x->size < y->size ? -1 : 1;
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+/**
+ * qsort comparator: resident processes by block, i.e. by address
+ */
+static int compare_resident(const void *a, const void *b)
+{
+    const Process *x = *(Process *const *)a;
+    const Process *y = *(Process *const *)b;
+
+    return (x->block_index > y->block_index) - (x->block_index < y->block_index);
+}
+
+/**
+ * qsort comparator: resident processes by block size, then ID
+ */
+static int compare_resident_sizes(const void *a, const void *b)
+{
+    const SwapResident *x = (const SwapResident *)a;
+    const SwapResident *y = (const SwapResident *)b;
+
+    if (x->size != y->size)
+        return x->size < y->size ? -1 : 1;
+    return (x->process->id > y->process->id) - (x->process->id < y->process->id);
+}
+
+/**
+ * Number of holes starting below an address
+ */
+static int swap_holes_below(const SwapSpace *swap, MemSize address)
+{
+    int low = 0, high = swap->hole_count;
+
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (swap->holes[mid].start < address)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * Position of a hole in the size-ordered array, or where it would go
+ */
+static int swap_hole_rank(const SwapSpace *swap, const SwapHole *hole)
+{
+    int low = 0, high = swap->hole_count;
+
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (compare_swap_holes(&swap->holes_by_size[mid], hole) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * Add a free range to both hole arrays
+ */
+static void swap_hole_insert(SwapSpace *swap, MemSize start, MemSize size)
+{
+    SwapHole hole = {start, size};
+
+    swap_reserve_holes(swap, swap->hole_count + 1);
+    int at = swap_holes_below(swap, start);
+    int rank = swap_hole_rank(swap, &hole);
+    memmove(&swap->holes[at + 1], &swap->holes[at], sizeof(SwapHole) * (size_t)(swap->hole_count - at));
+    memmove(&swap->holes_by_size[rank + 1], &swap->holes_by_size[rank], sizeof(SwapHole) * (size_t)(swap->hole_count - rank));
+    swap->holes[at] = hole;
+    swap->holes_by_size[rank] = hole;
+    swap->hole_count++;
+}
+
+/**
+ * Remove the hole at an address-order position from both hole arrays
+ */
+static void swap_hole_remove(SwapSpace *swap, int at)
+{
+    int rank = swap_hole_rank(swap, &swap->holes[at]);
+
+    memmove(&swap->holes[at], &swap->holes[at + 1], sizeof(SwapHole) * (size_t)(swap->hole_count - at - 1));
+    memmove(&swap->holes_by_size[rank], &swap->holes_by_size[rank + 1], sizeof(SwapHole) * (size_t)(swap->hole_count - rank - 1));
+    swap->hole_count--;
+}
+
+/**
+ * Size of the largest hole, read from the size-ordered end of the index
+ */
+static MemSize swap_largest_hole(const SwapSpace *swap)
+{
+    return swap->hole_count > 0 ? swap->holes_by_size[swap->hole_count - 1].size : 0;
+}
+
+/**
+ * Number of resident processes whose block starts below an address
+ */
+static int swap_resident_below(const MemoryManager *manager, MemSize address)
+{
+    const SwapSpace *swap = manager->swap;
+    int low = 0, high = swap->resident_count;
+
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (manager->blocks[swap->resident[mid]->block_index].start_address < address)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * Position of a resident process in the size-ordered array, or where it would go
+ */
+static int swap_resident_rank(const SwapSpace *swap, const SwapResident *entry)
+{
+    int low = 0, high = swap->resident_count;
+
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (compare_resident_sizes(&swap->resident_by_size[mid], entry) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * Number of resident processes whose block is smaller than size
+ */
+static int swap_resident_smaller(const SwapSpace *swap, MemSize size)
+{
+    int low = 0, high = swap->resident_count;
+
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (swap->resident_by_size[mid].size < size)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * Resident process that owns a block, or NULL for free and unswappable blocks
+ */
+static Process *swap_block_owner(const MemoryManager *manager, int block_index)
+{
+    const SwapSpace *swap = manager->swap;
+    int r = swap_resident_below(manager, manager->blocks[block_index].start_address);
+
+    if (r < swap->resident_count && swap->resident[r]->block_index == block_index)
+    {
+        return swap->resident[r];
+    }
+    return NULL;
+}
+
+/**
+ * Whether a process is an entry of the manager's process table
+ *
+ * Only those can be swapped; blocks held by anything else (the paging frame
+ * pool, for one) stay where they are.
+ */
+static bool swap_in_table(const MemoryManager *manager, const Process *process)
+{
+    return manager->process_table != NULL && process >= manager->process_table &&
+           process < manager->process_table + manager->process_count;
+}
+
+/**
+ * Rebuild the hole and resident indices from the block list
+ *
+ * Used when blocks change wholesale: a new manager, a restored snapshot or a
+ * placed batch. Every other change goes through swap_index_place and
+ * swap_index_release.
+ */
+void swap_index_rebuild(MemoryManager *manager)
+{
+    SwapSpace *swap = manager->swap;
+
+    // Runs of adjacent free blocks, merged or not, are one hole
+    swap->hole_count = 0;
+    for (int i = 0; i < manager->block_count;)
+    {
+        if (!is_block_free(&manager->blocks[i]))
+        {
+            i++;
+            continue;
+        }
+
+        swap_reserve_holes(swap, swap->hole_count + 1);
+        SwapHole *hole = &swap->holes[swap->hole_count++];
+        hole->start = manager->blocks[i].start_address;
+        hole->size = 0;
+        while (i < manager->block_count && is_block_free(&manager->blocks[i]))
+        {
+            hole->size += get_block_size(&manager->blocks[i++]);
+        }
+    }
+    memcpy(swap->holes_by_size, swap->holes, sizeof(SwapHole) * (size_t)swap->hole_count);
+    qsort(swap->holes_by_size, (size_t)swap->hole_count, sizeof(SwapHole), compare_swap_holes);
+
+    swap->resident_count = 0;
+    for (int j = 0; j < manager->process_count; j++)
+    {
+        Process *process = &manager->process_table[j];
+        if (process->state == PROCESS_RUNNING && process->block_index >= 0)
+        {
+            swap_reserve_resident(swap, swap->resident_count + 1);
+            swap->resident_by_size[swap->resident_count].size = get_block_size(&manager->blocks[process->block_index]);
+            swap->resident_by_size[swap->resident_count].process = process;
+            swap->resident[swap->resident_count++] = process;
+        }
+    }
+    qsort(swap->resident, (size_t)swap->resident_count, sizeof(Process *), compare_resident);
+    qsort(swap->resident_by_size, (size_t)swap->resident_count, sizeof(SwapResident), compare_resident_sizes);
+}
+
+/**
+ * Record a placement: cut its block out of its hole and index the process
+ *
+ * Called once the block is allocated and process->block_index is set.
+ */
+void swap_index_place(MemoryManager *manager, Process *process)
+{
+    SwapSpace *swap = manager->swap;
+    MemSize start = manager->blocks[process->block_index].start_address;
+    MemSize end = start + get_block_size(&manager->blocks[process->block_index]);
+
+    int at = swap_holes_below(swap, start + 1) - 1;
+    if (at >= 0 && swap->holes[at].start + swap->holes[at].size >= end)
+    {
+        SwapHole hole = swap->holes[at];
+        swap_hole_remove(swap, at);
+        if (hole.start < start)
+            swap_hole_insert(swap, hole.start, start - hole.start);
+        if (end < hole.start + hole.size)
+            swap_hole_insert(swap, end, hole.start + hole.size - end);
+    }
+
+    process->placed_at = ++swap->clock;
+    if (!swap_in_table(manager, process))
+    {
+        return;
+    }
+
+    SwapResident entry = {end - start, process};
+
+    swap_reserve_resident(swap, swap->resident_count + 1);
+    int r = swap_resident_below(manager, start);
+    int rank = swap_resident_rank(swap, &entry);
+    memmove(&swap->resident[r + 1], &swap->resident[r], sizeof(Process *) * (size_t)(swap->resident_count - r));
+    memmove(&swap->resident_by_size[rank + 1], &swap->resident_by_size[rank],
+            sizeof(SwapResident) * (size_t)(swap->resident_count - rank));
+    swap->resident[r] = process;
+    swap->resident_by_size[rank] = entry;
+    swap->resident_count++;
+}
+
+/**
+ * Record a release: drop the process and merge its block into the holes around it
+ *
+ * Called before the block is merged with its neighbours, while
+ * process->block_index still points at it.
+ */
+void swap_index_release(MemoryManager *manager, Process *process)
+{
+    SwapSpace *swap = manager->swap;
+    MemSize start = manager->blocks[process->block_index].start_address;
+    MemSize end = start + get_block_size(&manager->blocks[process->block_index]);
+
+    int r = swap_resident_below(manager, start);
+    if (r < swap->resident_count && swap->resident[r] == process)
+    {
+        SwapResident entry = {end - start, process};
+        int rank = swap_resident_rank(swap, &entry);
+
+        memmove(&swap->resident[r], &swap->resident[r + 1], sizeof(Process *) * (size_t)(swap->resident_count - r - 1));
+        memmove(&swap->resident_by_size[rank], &swap->resident_by_size[rank + 1],
+                sizeof(SwapResident) * (size_t)(swap->resident_count - rank - 1));
+        swap->resident_count--;
+    }
+
+    int at = swap_holes_below(swap, start);
+    if (at > 0 && swap->holes[at - 1].start + swap->holes[at - 1].size == start)
+    {
+        at--;
+        start = swap->holes[at].start;
+        swap_hole_remove(swap, at);
+    }
+    if (at < swap->hole_count && swap->holes[at].start == end)
+    {
+        end += swap->holes[at].size;
+        swap_hole_remove(swap, at);
+    }
+    swap_hole_insert(swap, start, end - start);
+}
+
+/**
+ * Whether window a is a better set of victims than window b under a policy
+ */
+static bool swap_window_better(SwapPolicy policy, const SwapWindow *a, const SwapWindow *b)
+{
+    switch (policy)
+    {
+    case SWAP_OLDEST:
+        // The window whose most recently placed victim was placed longest ago
+        if (a->newest != b->newest)
+            return a->newest < b->newest;
+        return a->bytes < b->bytes;
+    case SWAP_LARGEST_FIRST:
+        if (a->largest != b->largest)
+            return a->largest > b->largest;
+        if (a->victims != b->victims)
+            return a->victims < b->victims;
+        return a->bytes < b->bytes;
+    default:
+        if (a->bytes != b->bytes)
+            return a->bytes < b->bytes;
+        return a->victims < b->victims;
+    }
+}
+
+/**
+ * Score every shortest victim window ending in blocks [low, high]
+ *
+ * A two-pointer sweep yields the shortest window covering the request that
+ * ends at each block. Running sums and monotonic deques keep each window's
+ * bytes, victim count, newest placement and largest victim. Owners come from
+ * a cursor over the resident index, which is in the same order as the
+ * blocks, and kept in owner[low..high] for the deques.
+ */
+static void swap_sweep(MemoryManager *manager, int low, int high, MemSize request_size,
+                       Process **owner, int *newest_queue, int *largest_queue, SwapWindow *best)
+{
+    SwapSpace *swap = manager->swap;
+    int newest_head = 0, newest_tail = 0, largest_head = 0, largest_tail = 0;
+    MemSize span = 0, bytes = 0;
+    int victims = 0;
+    int first = low;
+    int r = swap_resident_below(manager, manager->blocks[low].start_address);
+
+    for (int last = low; last <= high; last++)
+    {
+        MemoryBlock *block = &manager->blocks[last];
+
+        owner[last] = NULL;
+        if (!is_block_free(block) && r < swap->resident_count && swap->resident[r]->block_index == last)
+        {
+            owner[last] = swap->resident[r++];
+        }
+
+        if (!is_block_free(block) && owner[last] == NULL)
+        {
+            // Unswappable: no window may cross it
+            first = last + 1;
+            span = bytes = 0;
+            victims = 0;
+            newest_head = newest_tail = largest_head = largest_tail = 0;
+            continue;
+        }
+
+        span += get_block_size(block);
+        if (!is_block_free(block))
+        {
+            bytes += get_block_size(block);
+            victims++;
+
+            uint64_t placed = owner[last]->placed_at;
+            while (newest_tail > newest_head && owner[newest_queue[newest_tail - 1]]->placed_at <= placed)
+                newest_tail--;
+            newest_queue[newest_tail++] = last;
+
+            while (largest_tail > largest_head && get_block_size(&manager->blocks[largest_queue[largest_tail - 1]]) <= get_block_size(block))
+                largest_tail--;
+            largest_queue[largest_tail++] = last;
+        }
+
+        // Drop blocks from the left while the window still covers the request
+        while (first < last && span - get_block_size(&manager->blocks[first]) >= request_size)
+        {
+            span -= get_block_size(&manager->blocks[first]);
+            if (!is_block_free(&manager->blocks[first]))
+            {
+                bytes -= get_block_size(&manager->blocks[first]);
+                victims--;
+            }
+            if (newest_tail > newest_head && newest_queue[newest_head] == first)
+                newest_head++;
+            if (largest_tail > largest_head && largest_queue[largest_head] == first)
+                largest_head++;
+            first++;
+        }
+
+        if (span < request_size || victims == 0)
+        {
+            continue;
+        }
+
+        SwapWindow window = {first, last, bytes, victims, owner[newest_queue[newest_head]]->placed_at,
+                             get_block_size(&manager->blocks[largest_queue[largest_head]])};
+        swap->windows_scored++;
+        if (best->first == -1 || swap_window_better(swap->policy, &window, best))
+        {
+            *best = window;
+        }
+    }
+}
+
+/**
+ * Pick victims from the size index when no window around a hole covers the request
+ *
+ * A process whose block covers the request is a window of its own: the
+ * smallest such block for Min-Bytes, the largest for Largest-First and the one
+ * placed longest ago for Oldest. When every process is smaller than the
+ * request, the window grows from the largest one, a block at a time towards
+ * the smaller neighbour, until it covers the request. It fails only when
+ * unswappable blocks cut it short.
+ */
+static void swap_pick_resident(MemoryManager *manager, MemSize request_size, SwapWindow *best)
+{
+    SwapSpace *swap = manager->swap;
+
+    if (swap->resident_count == 0)
+    {
+        return;
+    }
+
+    int fits = swap_resident_smaller(swap, request_size);
+    if (fits < swap->resident_count)
+    {
+        int pick = fits;
+        if (swap->policy == SWAP_LARGEST_FIRST)
+        {
+            pick = swap->resident_count - 1;
+        }
+        else if (swap->policy == SWAP_OLDEST)
+        {
+            for (int i = fits + 1; i < swap->resident_count; i++)
+            {
+                if (swap->resident_by_size[i].process->placed_at < swap->resident_by_size[pick].process->placed_at)
+                    pick = i;
+            }
+        }
+
+        const SwapResident *victim = &swap->resident_by_size[pick];
+        SwapWindow window = {victim->process->block_index, victim->process->block_index, victim->size, 1,
+                             victim->process->placed_at, victim->size};
+        swap->windows_scored++;
+        *best = window;
+        return;
+    }
+
+    const SwapResident *anchor = &swap->resident_by_size[swap->resident_count - 1];
+    SwapWindow window = {anchor->process->block_index, anchor->process->block_index, anchor->size, 1,
+                         anchor->process->placed_at, anchor->size};
+    MemSize span = anchor->size;
+
+    while (span < request_size)
+    {
+        int side = -1;
+        Process *side_owner = NULL;
+
+        if (window.first > 0)
+        {
+            Process *left = swap_block_owner(manager, window.first - 1);
+            if (left != NULL || is_block_free(&manager->blocks[window.first - 1]))
+            {
+                side = window.first - 1;
+                side_owner = left;
+            }
+        }
+        if (window.last + 1 < manager->block_count)
+        {
+            Process *right = swap_block_owner(manager, window.last + 1);
+            if ((right != NULL || is_block_free(&manager->blocks[window.last + 1])) &&
+                (side == -1 || get_block_size(&manager->blocks[window.last + 1]) < get_block_size(&manager->blocks[side])))
+            {
+                side = window.last + 1;
+                side_owner = right;
+            }
+        }
+        if (side == -1)
+        {
+            return;
+        }
+
+        span += get_block_size(&manager->blocks[side]);
+        if (side_owner != NULL)
+        {
+            window.bytes += get_block_size(&manager->blocks[side]);
+            window.victims++;
+            if (side_owner->placed_at > window.newest)
+                window.newest = side_owner->placed_at;
+        }
+        if (side < window.first)
+            window.first = side;
+        else
+            window.last = side;
+    }
+
+    swap->windows_scored++;
+    *best = window;
+}
+
+/**
+ * Swap processes out so that the request fits, choosing them by policy
+ *
+ * Victims only help if they open one contiguous hole together with the free
+ * blocks around them. The candidates are therefore windows of adjacent
+ * blocks whose span covers the request. They are looked for around the holes
+ * in the index: a shortest window that takes in a hole starts and ends within
+ * request_size of it, so only the blocks in those reaches are swept, with
+ * overlapping reaches swept once. Memory without holes, or whose holes have
+ * no window around them, is not swept; swap_pick_resident picks from the size
+ * index instead. Blocks that belong to no process in the table cannot be
+ * swapped and end windows.
+ *
+ * Returns:
+ *   true if victims were swapped out and a hole of request_size now exists
+ */
+bool swap_out_for(MemoryManager *manager, Process *process, MemSize request_size)
+{
+    SwapSpace *swap = manager->swap;
+
+    swap_reserve_scratch(swap, manager->block_count);
+    Process **owner = swap->owner;
+    int *newest_queue = swap->queues;
+    int *largest_queue = swap->queues + swap->scratch_capacity;
+    SwapWindow best = {-1, -1, 0, 0, 0, 0};
+
+    int low = -1, high = -1;
+    for (int h = 0; h < swap->hole_count; h++)
+    {
+        const SwapHole *hole = &swap->holes[h];
+        MemSize reach_start = hole->start > request_size ? hole->start - request_size : 0;
+        MemSize reach_end = hole->start + hole->size + request_size;
+        int reach_low = find_block_containing(manager, reach_start);
+        int reach_high = reach_end >= manager->total_size ? manager->block_count - 1
+                                                          : find_block_containing(manager, reach_end - 1);
+
+        if (low != -1 && reach_low <= high + 1)
+        {
+            high = reach_high > high ? reach_high : high;
+            continue;
+        }
+        if (low != -1)
+        {
+            swap_sweep(manager, low, high, request_size, owner, newest_queue, largest_queue, &best);
+        }
+        low = reach_low;
+        high = reach_high;
+    }
+    if (low != -1)
+    {
+        swap_sweep(manager, low, high, request_size, owner, newest_queue, largest_queue, &best);
+    }
+    if (best.first == -1)
+    {
+        swap_pick_resident(manager, request_size, &best);
+    }
+
+    if (best.first == -1)
+    {
+        swap->no_victims++;
+        return false;
+    }
+
+    // Block indices shift as victims are freed and merged, so collect them first
+    Process **chosen = swap->owner;
+    int chosen_count = 0;
+    int r = swap_resident_below(manager, manager->blocks[best.first].start_address);
+    for (int i = best.first; i <= best.last; i++)
+    {
+        if (r < swap->resident_count && swap->resident[r]->block_index == i)
+            chosen[chosen_count++] = swap->resident[r++];
+    }
+
+    if (manager->verbose)
+        log_untimed(manager, "\nSwapping (%s): %d process(es), %lld %s, out to make room for P%d\n",
+               get_swap_policy_name(swap->policy), chosen_count, best.bytes, get_unit_name(), process->id);
+
+    for (int i = 0; i < chosen_count; i++)
+    {
+        swap_out_process(manager, chosen[i]);
+    }
+    if (manager->coalesce_policy == COALESCE_DEFERRED)
+    {
+        coalesce_deferred_blocks(manager);
+    }
+
+    return true;
+}
+
+/**
+ * Move one running process to the backing store
+ */
+void swap_out_process(MemoryManager *manager, Process *victim)
+{
+    SwapSpace *swap = manager->swap;
+
+    if (swap->count == swap->capacity)
+    {
+        Process **swapped = realloc(swap->swapped, sizeof(Process *) * (size_t)swap->capacity * 2);
+        if (swapped == NULL)
+        {
+            fprintf(stderr, "Error: Could not grow backing store\n");
+            exit(EXIT_FAILURE);
+        }
+        swap->swapped = swapped;
+        swap->capacity *= 2;
+    }
+
+    if (manager->verbose)
+        log_untimed(manager, "  Swapped out P%d (%lld %s)\n", victim->id, victim->size, get_unit_name());
+
+    // Shadows see the swap-out as a free
+    if (manager->adaptive != NULL)
+    {
+        adaptive_record_deallocation(manager, victim);
+    }
+    release_process(manager, victim);
+    victim->state = PROCESS_SWAPPED;
+
+    swap->swapped[swap->count++] = victim;
+    swap->store_size += victim->size;
+    if (swap->store_size > swap->peak_store_size)
+    {
+        swap->peak_store_size = swap->store_size;
+    }
+    swap->swap_outs++;
+    swap->bytes_out += victim->size;
+}
+
+/**
+ * Remove a process from the backing store list
+ */
+static void swap_remove(SwapSpace *swap, int index)
+{
+    swap->store_size -= swap->swapped[index]->size;
+    memmove(&swap->swapped[index], &swap->swapped[index + 1], sizeof(Process *) * (size_t)(swap->count - index - 1));
+    swap->count--;
+}
+
+/**
+ * Bring swapped processes back in, oldest first, while they fit
+ *
+ * Called after a free. Swap-ins never evict anything. The largest hole, read
+ * from the hole index, is the bound for which processes are tried, so a free
+ * that is too small for all of them costs no placement attempts.
+ */
+void swap_in_waiting(MemoryManager *manager)
+{
+    SwapSpace *swap = manager->swap;
+    MemSize hole = swap_largest_hole(swap);
+
+    swap->swapping_in = true;
+    for (int i = 0; i < swap->count;)
+    {
+        Process *process = swap->swapped[i];
+        if (round_request_size(manager, process->size) > hole)
+        {
+            i++;
+            continue;
+        }
+
+        process->state = PROCESS_NEW;
+        if (!allocate_memory(manager, process))
+        {
+            process->state = PROCESS_SWAPPED;
+            i++;
+            continue;
+        }
+
+        if (manager->verbose)
+            log_untimed(manager, "  Swapped in P%d (%lld %s) at address %lld\n", process->id, process->size,
+                        get_unit_name(), manager->blocks[process->block_index].start_address);
+
+        swap_remove(swap, i);
+        swap->swap_ins++;
+        swap->bytes_in += process->size;
+        hole = swap_largest_hole(swap);
+    }
+    swap->swapping_in = false;
+}
+
+/**
+ * Drop a process that ended while swapped out
+ */
+void swap_discard(MemoryManager *manager, Process *process)
+{
+    SwapSpace *swap = manager->swap;
+
+    for (int i = 0; i < swap->count; i++)
+    {
+        if (swap->swapped[i] == process)
+        {
+            swap_remove(swap, i);
+            swap->discarded++;
+            break;
+        }
+    }
+    process->state = PROCESS_TERMINATED;
+    process->block_index = -1;
+}
+
+/**
+ * Print swap traffic and victim selection counters
+ */
+void print_swap_report(const SwapSpace *swap)
+{
+    printf("Swapping (%s): %d swapped out, %d swapped in, %d still out, %d ended while out\n",
+           get_swap_policy_name(swap->policy), swap->swap_outs, swap->swap_ins, swap->count, swap->discarded);
+    printf("  Traffic: %lld %s out, %lld %s in; backing store %lld %s now, peak %lld %s\n",
+           swap->bytes_out, get_unit_name(), swap->bytes_in, get_unit_name(),
+           swap->store_size, get_unit_name(), swap->peak_store_size, get_unit_name());
+    printf("  Requests placed by swapping: %d, no victims possible: %d, windows scored: %d\n",
+           swap->rescued, swap->no_victims, swap->windows_scored);
+}
+
+/**
+ * Get the display name of a page replacement policy
+ */
+const char *get_replacement_policy_name(ReplacementPolicy policy)
+{
+    switch (policy)
+    {
+    case REPLACE_LRU:
+        return "LRU";
+    case REPLACE_CLOCK:
+        return "CLOCK";
+    case REPLACE_ARC:
+        return "ARC";
+    default:
+        break;
+    }
+    return "Unknown";
+}
+
+/**
+ * Create a paged memory system whose frames come from the manager
+ *
+ * One contiguous frame pool is allocated from the manager (as process
+ * PAGING_POOL_ID) and split into page-sized frames. Each process gets a page
+ * table covering its size, rounded up to whole pages.
+ *
+ * Parameters:
+ *   manager - Memory manager supplying the frame pool
+ *   processes - Processes that get a page table
+ *   num_processes - Number of processes
+ *   policy - Page replacement policy
+ *   frame_count - Frames in the pool (0 = PAGING_DEFAULT_FRAMES_PERCENT of the
+ *                 pages); never more than fit in free memory
+ *   page_size - Page and frame size in allocation units
+ *
+ * Returns:
+ *   The paging system, or NULL if the frame pool could not be allocated
+ */
+PagingSystem *paging_create(MemoryManager *manager, Process processes[], int num_processes,
+                            ReplacementPolicy policy, int frame_count, MemSize page_size)
+{
+    MemSize total_pages = 0;
+    for (int i = 0; i < num_processes; i++)
+    {
+        total_pages += (processes[i].size + page_size - 1) / page_size;
+    }
+
+    // A pool that holds every page never evicts, so by default it gets a fraction of them
+    MemSize max_frames = manager->free_size / page_size;
+    if (max_frames > PAGING_MAX_FRAMES)
+        max_frames = PAGING_MAX_FRAMES;
+    if (frame_count <= 0)
+    {
+        MemSize default_frames = total_pages * PAGING_DEFAULT_FRAMES_PERCENT / 100;
+        frame_count = (int)(default_frames < 1 ? 1 : default_frames < max_frames ? default_frames : max_frames);
+    }
+    if (frame_count > max_frames)
+        frame_count = (int)max_frames;
+
+    if (frame_count < 1 || total_pages > INT32_MAX)
+    {
+        return NULL;
+    }
+
+    PagingSystem *paging = calloc(1, sizeof(PagingSystem));
+    if (paging == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate paging system\n");
+        exit(EXIT_FAILURE);
+    }
+
+    paging->pool.id = PAGING_POOL_ID;
+    paging->pool.size = (MemSize)frame_count * page_size;
+    paging->pool.state = PROCESS_NEW;
+    paging->pool.block_index = -1;
+    if (!allocate_memory(manager, &paging->pool))
+    {
+        free(paging);
+        return NULL;
+    }
+
+    paging->policy = policy;
+    paging->page_size = page_size;
+    paging->pool_start = manager->blocks[paging->pool.block_index].start_address;
+    paging->frame_count = frame_count;
+    paging->process_count = num_processes;
+    paging->page_count = (int32_t)total_pages;
+
+    size_t pages = (size_t)total_pages;
+    paging->process_ids = malloc(sizeof(int) * num_processes);
+    paging->page_table_base = malloc(sizeof(int32_t) * (num_processes + 1));
+    paging->process_faults = calloc(num_processes, sizeof(uint64_t));
+    paging->page_frame = malloc(sizeof(int32_t) * pages);
+    paging->page_owner = malloc(sizeof(int32_t) * pages);
+    paging->page_list = malloc(pages);
+    paging->prev = malloc(sizeof(int32_t) * pages);
+    paging->next = malloc(sizeof(int32_t) * pages);
+    paging->frame_page = malloc(sizeof(int32_t) * frame_count);
+    paging->frame_referenced = calloc(frame_count, 1);
+    if (paging->process_ids == NULL || paging->page_table_base == NULL || paging->process_faults == NULL ||
+        (pages > 0 && (paging->page_frame == NULL || paging->page_owner == NULL || paging->page_list == NULL ||
+                       paging->prev == NULL || paging->next == NULL)) ||
+        paging->frame_page == NULL || paging->frame_referenced == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate page tables\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t page = 0;
+    for (int i = 0; i < num_processes; i++)
+    {
+        int32_t process_pages = (int32_t)((processes[i].size + page_size - 1) / page_size);
+        paging->process_ids[i] = processes[i].id;
+        paging->page_table_base[i] = page;
+        for (int32_t p = 0; p < process_pages; p++)
+        {
+            paging->page_owner[page + p] = i;
+        }
+        page += process_pages;
+    }
+    paging->page_table_base[num_processes] = page;
+
+    memset(paging->page_frame, 0xFF, sizeof(int32_t) * pages); // -1: not resident
+    memset(paging->page_list, PAGE_LIST_NONE, pages);
+    memset(paging->frame_page, 0xFF, sizeof(int32_t) * frame_count);
+    for (int l = 0; l < NUM_PAGE_LISTS; l++)
+    {
+        paging->lists[l].head = -1;
+        paging->lists[l].tail = -1;
+    }
+
+    return paging;
+}
+
+/**
+ * Free a paging system and return its frame pool to the manager
+ */
+void paging_destroy(PagingSystem *paging, MemoryManager *manager)
+{
+    if (paging == NULL)
+    {
+        return;
+    }
+    deallocate_memory(manager, &paging->pool);
+    free(paging->process_ids);
+    free(paging->page_table_base);
+    free(paging->process_faults);
+    free(paging->page_frame);
+    free(paging->page_owner);
+    free(paging->page_list);
+    free(paging->prev);
+    free(paging->next);
+    free(paging->frame_page);
+    free(paging->frame_referenced);
+    free(paging);
+}
+
+/**
+ * Put a page at the MRU end of a list
+ */
+static void page_list_push(PagingSystem *paging, PageListId list_id, int32_t page)
+{
+    PageList *list = &paging->lists[list_id];
+
+    paging->prev[page] = -1;
+    paging->next[page] = list->head;
+    if (list->head >= 0)
+        paging->prev[list->head] = page;
+    else
+        list->tail = page;
+    list->head = page;
+    list->size++;
+    paging->page_list[page] = (uint8_t)list_id;
+}
+
+/**
+ * Take a page off whatever list it is on
+ */
+static void page_list_remove(PagingSystem *paging, int32_t page)
+{
+    PageList *list = &paging->lists[paging->page_list[page]];
+    int32_t prev = paging->prev[page];
+    int32_t next = paging->next[page];
+
+    if (prev >= 0)
+        paging->next[prev] = next;
+    else
+        list->head = next;
+    if (next >= 0)
+        paging->prev[next] = prev;
+    else
+        list->tail = prev;
+    list->size--;
+    paging->page_list[page] = PAGE_LIST_NONE;
+}
+
+/**
+ * Evict a resident page: clear its page table entry and TLB entry
+ *
+ * Returns:
+ *   The frame it occupied
+ */
+static int paging_evict(PagingSystem *paging, int32_t page)
+{
+    int frame = paging->page_frame[page];
+
+    paging->page_frame[page] = -1;
+    paging->frame_page[frame] = -1;
+    paging->evictions++;
+
+    // TLB shootdown
+    int32_t *set = paging->tlb[page & (TLB_SETS - 1)];
+    for (int way = 0; way < TLB_WAYS; way++)
+    {
+        if (set[way] == page + 1)
+        {
+            for (; way < TLB_WAYS - 1; way++)
+                set[way] = set[way + 1];
+            set[TLB_WAYS - 1] = 0;
+            break;
+        }
+    }
+    return frame;
+}
+
+/**
+ * ARC REPLACE: evict from T1 or T2 depending on the target size of T1
+ */
+static int arc_replace(PagingSystem *paging, bool in_frequent_ghost)
+{
+    if (paging->frames_used < paging->frame_count)
+    {
+        return paging->frames_used++;
+    }
+
+    PageList *t1 = &paging->lists[PAGE_LIST_RECENT];
+    PageList *t2 = &paging->lists[PAGE_LIST_FREQUENT];
+    int32_t victim;
+
+    if (t1->size > 0 && (t2->size == 0 || t1->size > paging->arc_target ||
+                         (in_frequent_ghost && t1->size == paging->arc_target)))
+    {
+        victim = t1->tail;
+        page_list_remove(paging, victim);
+        page_list_push(paging, PAGE_LIST_RECENT_GHOST, victim);
+    }
+    else
+    {
+        victim = t2->tail;
+        page_list_remove(paging, victim);
+        page_list_push(paging, PAGE_LIST_FREQUENT_GHOST, victim);
+    }
+    return paging_evict(paging, victim);
+}
+
+/**
+ * Forget the LRU page of a ghost list
+ */
+static void arc_drop_ghost(PagingSystem *paging, PageListId list_id)
+{
+    if (paging->lists[list_id].tail >= 0)
+    {
+        page_list_remove(paging, paging->lists[list_id].tail);
+    }
+}
+
+/**
+ * ARC miss handling (Megiddo and Modha, cases II-IV); returns the frame to load into
+ */
+static int arc_fault(PagingSystem *paging, int32_t page)
+{
+    PageList *t1 = &paging->lists[PAGE_LIST_RECENT];
+    PageList *t2 = &paging->lists[PAGE_LIST_FREQUENT];
+    PageList *b1 = &paging->lists[PAGE_LIST_RECENT_GHOST];
+    PageList *b2 = &paging->lists[PAGE_LIST_FREQUENT_GHOST];
+    int capacity = paging->frame_count;
+    int frame;
+
+    if (paging->page_list[page] == PAGE_LIST_RECENT_GHOST)
+    {
+        // Recency was undervalued: grow T1's target
+        int delta = (b1->size >= b2->size) ? 1 : b2->size / b1->size;
+        paging->arc_target = (paging->arc_target + delta < capacity) ? paging->arc_target + delta : capacity;
+        page_list_remove(paging, page);
+        frame = arc_replace(paging, false);
+        page_list_push(paging, PAGE_LIST_FREQUENT, page);
+        return frame;
+    }
+
+    if (paging->page_list[page] == PAGE_LIST_FREQUENT_GHOST)
+    {
+        // Frequency was undervalued: shrink T1's target
+        int delta = (b2->size >= b1->size) ? 1 : b1->size / b2->size;
+        paging->arc_target = (paging->arc_target > delta) ? paging->arc_target - delta : 0;
+        page_list_remove(paging, page);
+        frame = arc_replace(paging, true);
+        page_list_push(paging, PAGE_LIST_FREQUENT, page);
+        return frame;
+    }
+
+    // Not in any list
+    if (t1->size + b1->size == capacity)
+    {
+        if (t1->size < capacity)
+        {
+            arc_drop_ghost(paging, PAGE_LIST_RECENT_GHOST);
+            frame = arc_replace(paging, false);
+        }
+        else
+        {
+            int32_t victim = t1->tail;
+            page_list_remove(paging, victim);
+            frame = paging_evict(paging, victim);
+        }
+    }
+    else
+    {
+        if (t1->size + t2->size + b1->size + b2->size >= 2 * capacity)
+        {
+            arc_drop_ghost(paging, PAGE_LIST_FREQUENT_GHOST);
+        }
+        frame = arc_replace(paging, false);
+    }
+    page_list_push(paging, PAGE_LIST_RECENT, page);
+    return frame;
+}
+
+/**
+ * Load a non-resident page, evicting a victim if the pool is full
+ */
+static void paging_fault(PagingSystem *paging, int32_t page)
+{
+    int frame;
+
+    paging->faults++;
+    paging->process_faults[paging->page_owner[page]]++;
+
+    switch (paging->policy)
+    {
+    case REPLACE_CLOCK:
+        if (paging->frames_used < paging->frame_count)
+        {
+            frame = paging->frames_used++;
+        }
+        else
+        {
+            // Second chance: clear reference bits until an unreferenced frame comes round
+            while (paging->frame_referenced[paging->clock_hand])
+            {
+                paging->frame_referenced[paging->clock_hand] = 0;
+                paging->clock_hand = (paging->clock_hand + 1) % paging->frame_count;
+            }
+            frame = paging_evict(paging, paging->frame_page[paging->clock_hand]);
+            paging->clock_hand = (paging->clock_hand + 1) % paging->frame_count;
+        }
+        paging->frame_referenced[frame] = 1;
+        break;
+    case REPLACE_ARC:
+        frame = arc_fault(paging, page);
+        break;
+    case REPLACE_LRU:
+    default:
+        if (paging->frames_used < paging->frame_count)
+        {
+            frame = paging->frames_used++;
+        }
+        else
+        {
+            int32_t victim = paging->lists[PAGE_LIST_RECENT].tail;
+            page_list_remove(paging, victim);
+            frame = paging_evict(paging, victim);
+        }
+        page_list_push(paging, PAGE_LIST_RECENT, page);
+        break;
+    }
+
+    paging->page_frame[page] = frame;
+    paging->frame_page[frame] = page;
+}
+
+/**
+ * Update the replacement state after a reference to a resident page
+ */
+static void paging_touch(PagingSystem *paging, int32_t page)
+{
+    switch (paging->policy)
+    {
+    case REPLACE_CLOCK:
+        paging->frame_referenced[paging->page_frame[page]] = 1;
+        break;
+    case REPLACE_ARC:
+        page_list_remove(paging, page);
+        page_list_push(paging, PAGE_LIST_FREQUENT, page);
+        break;
+    case REPLACE_LRU:
+    default:
+        if (paging->lists[PAGE_LIST_RECENT].head != page)
+        {
+            page_list_remove(paging, page);
+            page_list_push(paging, PAGE_LIST_RECENT, page);
+        }
+        break;
+    }
+}
+
+/**
+ * Replay one memory reference: TLB lookup, page table walk, fault handling
+ *
+ * The TLB is set associative and tagged with the global page number, so it
+ * acts as if tagged with an address space ID and never needs a full flush.
+ */
+void paging_reference(PagingSystem *paging, int32_t page)
+{
+    int32_t *set = paging->tlb[page & (TLB_SETS - 1)];
+    int32_t tag = page + 1;
+    int way = 0;
+
+    paging->references++;
+    while (way < TLB_WAYS && set[way] != tag)
+    {
+        way++;
+    }
+
+    if (way < TLB_WAYS)
+    {
+        paging->tlb_hits++;
+        paging_touch(paging, page);
+    }
+    else
+    {
+        way = TLB_WAYS - 1; // Refill into the LRU way
+        if (paging->page_frame[page] < 0)
+        {
+            paging_fault(paging, page);
+        }
+        else
+        {
+            paging->walk_hits++;
+            paging_touch(paging, page);
+        }
+    }
+
+    // Move the entry to the MRU way
+    for (; way > 0; way--)
+    {
+        set[way] = set[way - 1];
+    }
+    set[0] = tag;
+}
+
+/**
+ * Read a memory-reference trace
+ *
+ * Each line is "PROCESS_ID ADDRESS", the address being a virtual address in
+ * allocation units within that process. Lines starting with '#' are skipped.
+ * References are translated to global page numbers up front so the replay
+ * loop only touches flat arrays.
+ *
+ * Returns:
+ *   Array of global page numbers (caller frees), or NULL on error
+ */
+int32_t *load_reference_trace(const char *filename, PagingSystem *paging, size_t *count)
+{
+    FILE *file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: Could not open trace file '%s'\n", filename);
+        return NULL;
+    }
+
+    size_t capacity = 1024;
+    int32_t *trace = malloc(sizeof(int32_t) * capacity);
+    if (trace == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate trace\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[MAX_LINE_LENGTH];
+    int line_number = 0;
+    int skipped = 0;
+    *count = 0;
+    while (fgets(line, MAX_LINE_LENGTH, file) != NULL)
+    {
+        line_number++;
+        if (line[0] == '\n' || line[0] == '#')
+        {
+            continue;
+        }
+
+        int id;
+        MemSize address;
+        if (sscanf(line, "%d %lld", &id, &address) != 2)
+        {
+            skipped++;
+            continue;
+        }
+
+        int process = 0;
+        while (process < paging->process_count && paging->process_ids[process] != id)
+        {
+            process++;
+        }
+        MemSize page = (address >= 0) ? address / paging->page_size : -1;
+        if (process == paging->process_count || page < 0 ||
+            page >= paging->page_table_base[process + 1] - paging->page_table_base[process])
+        {
+            skipped++;
+            continue;
+        }
+
+        if (*count == capacity)
+        {
+            capacity *= 2;
+            trace = realloc(trace, sizeof(int32_t) * capacity);
+            if (trace == NULL)
+            {
+                fprintf(stderr, "Error: Could not allocate trace\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        trace[(*count)++] = paging->page_table_base[process] + (int32_t)page;
+    }
+    fclose(file);
+
+    if (skipped > 0)
+    {
+        fprintf(stderr, "Warning: Skipped %d invalid trace lines out of %d\n", skipped, line_number);
+    }
+    return trace;
+}
+
+/**
+ * xorshift64 step (synthetic page traces and the adversarial search)
+ */
+static uint64_t xorshift_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/**
+ * Generate a synthetic reference trace with locality
+ *
+ * Processes take turns in bursts of PAGING_BURST references. Within a burst,
+ * 70% of references hit a hot fifth of the process's pages, 20% continue a
+ * sequential scan and 10% are uniform, so recency- and frequency-based
+ * policies behave differently.
+ *
+ * Returns:
+ *   Array of global page numbers (caller frees)
+ */
+int32_t *generate_reference_trace(PagingSystem *paging, size_t count, uint64_t seed)
+{
+    int32_t *trace = malloc(sizeof(int32_t) * (count > 0 ? count : 1));
+    int32_t *hot_start = malloc(sizeof(int32_t) * paging->process_count);
+    int32_t *scan = calloc(paging->process_count, sizeof(int32_t));
+    if (trace == NULL || hot_start == NULL || scan == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate trace\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t state = seed ? seed : 1;
+    for (int p = 0; p < paging->process_count; p++)
+    {
+        int32_t pages = paging->page_table_base[p + 1] - paging->page_table_base[p];
+        hot_start[p] = pages > 0 ? (int32_t)(xorshift_random(&state) % pages) : 0;
+    }
+
+    size_t i = 0;
+    while (i < count)
+    {
+        int p = (int)(xorshift_random(&state) % paging->process_count);
+        int32_t base = paging->page_table_base[p];
+        int32_t pages = paging->page_table_base[p + 1] - base;
+        int32_t hot = pages / 5 > 0 ? pages / 5 : 1;
+        if (pages == 0)
+        {
+            continue;
+        }
+
+        for (int r = 0; r < PAGING_BURST && i < count; r++)
+        {
+            uint64_t random = xorshift_random(&state);
+            int kind = (int)(random % 10);
+            int32_t page;
+
+            if (kind < 7)
+                page = (hot_start[p] + (int32_t)((random >> 8) % hot)) % pages;
+            else if (kind < 9)
+                page = scan[p]++ % pages;
+            else
+                page = (int32_t)((random >> 8) % pages);
+            trace[i++] = base + page;
+        }
+    }
+
+    free(hot_start);
+    free(scan);
+    return trace;
+}
+
+/**
+ * Print hit rates, fault counts and replay throughput of a paging run
+ */
+void print_paging_report(const PagingSystem *paging, double seconds)
+{
+    double references = paging->references > 0 ? (double)paging->references : 1.0;
+
+    printf("\n--- Paging Results (%s, %d frames of %lld %s at address %lld) ---\n",
+           get_replacement_policy_name(paging->policy), paging->frame_count,
+           paging->page_size, get_unit_name(), paging->pool_start);
+    printf("References: %llu over %d pages in %d page tables\n",
+           (unsigned long long)paging->references, paging->page_count, paging->process_count);
+    printf("TLB (%d sets x %d ways): %llu hits (%.2f%%)\n", TLB_SETS, TLB_WAYS,
+           (unsigned long long)paging->tlb_hits, paging->tlb_hits / references * 100.0);
+    printf("Page Hits: %llu (%.2f%%), Page Faults: %llu (%.2f%%), Evictions: %llu\n",
+           (unsigned long long)(paging->tlb_hits + paging->walk_hits),
+           (paging->tlb_hits + paging->walk_hits) / references * 100.0,
+           (unsigned long long)paging->faults, paging->faults / references * 100.0,
+           (unsigned long long)paging->evictions);
+    printf("Faults per Process:");
+    for (int i = 0; i < paging->process_count; i++)
+    {
+        printf(" P%d=%llu", paging->process_ids[i], (unsigned long long)paging->process_faults[i]);
+    }
+    printf("\n");
+    if (seconds > 0)
+    {
+        printf("Replay: %.3f s, %.1f M references/s\n", seconds, references / seconds / 1e6);
+    }
+}
+
+/**
+ * Paged mode: replay a reference trace under one or all replacement policies
+ *
+ * Every policy gets a fresh First Fit manager of the input memory size; the
+ * frame pool is allocated from it and each input process gets a page table.
+ */
+void run_paging_simulation(Process processes[], int num_processes)
+{
+    int first = sim_options.paging_compare_all ? 0 : (int)sim_options.paging_policy;
+    int last = sim_options.paging_compare_all ? NUM_REPLACEMENT_POLICIES - 1 : first;
+    int32_t *trace = NULL;
+    size_t trace_length = 0;
+
+    printf("\n===== PAGED VIRTUAL MEMORY SIMULATION =====\n");
+
+    for (int policy = first; policy <= last; policy++)
+    {
+        MemoryManager manager;
+        initialize_memory_manager(&manager, FIRST_FIT);
+        manager.verbose = false;
+
+        PagingSystem *paging = paging_create(&manager, processes, num_processes, (ReplacementPolicy)policy,
+                                             sim_options.frame_count, bytes_to_units(PAGING_PAGE_BYTES));
+        if (paging == NULL)
+        {
+            if (sim_options.frame_count > 0)
+                fprintf(stderr, "Error: Could not allocate a frame pool of %d frames\n", sim_options.frame_count);
+            else
+                fprintf(stderr, "Error: Could not allocate the default frame pool\n");
+            destroy_memory_manager(&manager);
+            break;
+        }
+
+        // The trace only depends on the page tables, which are the same for every policy
+        if (trace == NULL)
+        {
+            if (sim_options.trace_file != NULL)
+            {
+                trace = load_reference_trace(sim_options.trace_file, paging, &trace_length);
+            }
+            else
+            {
+                trace_length = PAGING_REFERENCES;
+                trace = generate_reference_trace(paging, trace_length, BENCH_SEED);
+            }
+            if (trace == NULL)
+            {
+                paging_destroy(paging, &manager);
+                destroy_memory_manager(&manager);
+                break;
+            }
+        }
+
+        long long start = now_ns();
+        for (size_t i = 0; i < trace_length; i++)
+        {
+            paging_reference(paging, trace[i]);
+        }
+        double seconds = (now_ns() - start) / 1e9;
+
+        print_paging_report(paging, seconds);
+        paging_destroy(paging, &manager);
+        destroy_memory_manager(&manager);
+    }
+
+    free(trace);
+}
+
+/**
+ * Get the display name of a NUMA placement policy
+ */
+const char *get_numa_policy_name(NumaPolicy policy)
+{
+    switch (policy)
+    {
+    case NUMA_LOCAL_FIRST:
+        return "Local-First";
+    case NUMA_INTERLEAVE:
+        return "Interleave";
+    case NUMA_SPILL_OVER:
+        return "Spill-Over";
+    default:
+        break;
+    }
+    return "Unknown";
+}
+
+/**
+ * Split the configured memory into equal nodes, each its own manager
+ *
+ * Distances default to NUMA_LOCAL_DISTANCE locally plus 10 per hop on a ring
+ * of nodes (so two nodes are 10/20 apart, as on a typical two-socket server).
+ */
+void numa_init(NumaSystem *numa, int node_count, AllocationStrategy strategy, NumaPolicy policy)
+{
+    memset(numa, 0, sizeof(NumaSystem));
+    numa->node_count = node_count;
+    numa->policy = policy;
+
+    // Each node is a manager over its share of memory; the last takes the remainder
+    MemSize total = memory_size;
+    for (int n = 0; n < node_count; n++)
+    {
+        memory_size = (n < node_count - 1) ? total / node_count : total - (total / node_count) * (node_count - 1);
+        initialize_memory_manager(&numa->nodes[n], strategy);
+        numa->nodes[n].verbose = false;
+    }
+    memory_size = total;
+
+    for (int i = 0; i < node_count; i++)
+    {
+        for (int j = 0; j < node_count; j++)
+        {
+            int hops = abs(i - j) < node_count - abs(i - j) ? abs(i - j) : node_count - abs(i - j);
+            numa->distance[i][j] = (i == j) ? NUMA_LOCAL_DISTANCE : NUMA_REMOTE_DISTANCE + 10 * (hops - 1);
+        }
+    }
+    numa_order_nodes(numa);
+}
+
+/**
+ * Release every node manager
+ */
+void numa_destroy(NumaSystem *numa)
+{
+    for (int n = 0; n < numa->node_count; n++)
+    {
+        destroy_memory_manager(&numa->nodes[n]);
+    }
+}
+
+/**
+ * Read a node distance matrix: node_count rows of node_count positive integers
+ */
+bool numa_load_distances(NumaSystem *numa, const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: Could not open distance file '%s'\n", filename);
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < numa->node_count && ok; i++)
+    {
+        for (int j = 0; j < numa->node_count && ok; j++)
+        {
+            ok = fscanf(file, "%d", &numa->distance[i][j]) == 1 && numa->distance[i][j] > 0;
+        }
+    }
+    fclose(file);
+
+    if (!ok)
+    {
+        fprintf(stderr, "Error: Distance file '%s' needs %d x %d positive integers\n",
+                filename, numa->node_count, numa->node_count);
+        return false;
+    }
+    numa_order_nodes(numa);
+    return true;
+}
+
+/**
+ * Order the nodes by distance from each node (ties by node number)
+ */
+void numa_order_nodes(NumaSystem *numa)
+{
+    for (int home = 0; home < numa->node_count; home++)
+    {
+        int *order = numa->nearest[home];
+        for (int n = 0; n < numa->node_count; n++)
+        {
+            // Insertion sort; node counts are tiny
+            int k = n;
+            while (k > 0 && numa->distance[home][order[k - 1]] > numa->distance[home][n])
+            {
+                order[k] = order[k - 1];
+                k--;
+            }
+            order[k] = n;
+        }
+    }
+}
+
+/**
+ * Place a request according to the NUMA policy
+ *
+ * Each node keeps its own copy of the slot table so block indices stay in
+ * sync per node; the request is copied into the chosen node's slot.
+ *
+ * Parameters:
+ *   numa - NUMA system
+ *   node_processes - Per-node slot tables
+ *   slot - Slot of the request
+ *   request - Process ID and size to place
+ *   home - Node of the CPU the process runs on
+ *
+ * Returns:
+ *   Node the process was placed on, or -1 if no node could take it
+ */
+int numa_allocate(NumaSystem *numa, Process node_processes[][BENCH_SLOTS], int slot, const Process *request, int home)
+{
+    int candidates[MAX_NUMA_NODES];
+    int count = 0;
+
+    switch (numa->policy)
+    {
+    case NUMA_INTERLEAVE:
+        for (int k = 0; k < numa->node_count; k++)
+        {
+            candidates[count++] = (numa->next_interleave + k) % numa->node_count;
+        }
+        numa->next_interleave = (numa->next_interleave + 1) % numa->node_count;
+        break;
+    case NUMA_SPILL_OVER:
+        // Nodes that stay under the watermark first, nearest first; then the rest
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int k = 0; k < numa->node_count; k++)
+            {
+                MemoryManager *node = &numa->nodes[numa->nearest[home][k]];
+                double after = (double)(node->total_size - node->free_size + request->size) / node->total_size;
+                if ((after <= NUMA_SPILL_WATERMARK) == (pass == 0))
+                    candidates[count++] = numa->nearest[home][k];
+            }
+        }
+        break;
+    case NUMA_LOCAL_FIRST:
+    default:
+        for (int k = 0; k < numa->node_count; k++)
+        {
+            candidates[count++] = numa->nearest[home][k];
+        }
+        break;
+    }
+
+    numa->allocation_attempts++;
+    for (int k = 0; k < count; k++)
+    {
+        int node = candidates[k];
+        Process *process = &node_processes[node][slot];
+        process->id = request->id;
+        process->size = request->size;
+        process->state = PROCESS_NEW;
+        process->block_index = -1;
+
+        if (allocate_memory(&numa->nodes[node], process))
+        {
+            numa->allocations++;
+            if (node != home)
+                numa->remote_allocations++;
+            numa->weighted_cost += (double)request->size * numa->distance[home][node];
+            numa->placed_size += (double)request->size;
+            return node;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Free a slot's block on the node holding it
+ */
+void numa_deallocate(NumaSystem *numa, Process node_processes[][BENCH_SLOTS], int slot, int node)
+{
+    deallocate_memory(&numa->nodes[node], &node_processes[node][slot]);
+}
+
+/**
+ * Sample the utilization of every node
+ */
+void numa_sample(NumaSystem *numa)
+{
+    for (int n = 0; n < numa->node_count; n++)
+    {
+        MemoryManager *node = &numa->nodes[n];
+        double utilization = (double)(node->total_size - node->free_size) / node->total_size;
+
+        numa->utilization_sum[n] += utilization;
+        if (utilization > numa->peak_utilization[n])
+            numa->peak_utilization[n] = utilization;
+    }
+    numa->utilization_samples++;
+}
+
+/**
+ * Print one result row: success, remote ratio, access cost and node utilization
+ *
+ * Access cost is the size-weighted average distance of placements relative
+ * to a local access, so 1.00 means every byte was placed on its home node.
+ */
+void print_numa_report(NumaSystem *numa, AllocationStrategy strategy, Statistics *stats)
+{
+    char success_str[20], remote_str[20], cost_str[20];
+    snprintf(success_str, sizeof(success_str), "%.1f%%",
+             stats->allocation_attempts > 0 ? (double)stats->successful_allocations / stats->allocation_attempts * 100.0 : 0.0);
+    snprintf(remote_str, sizeof(remote_str), "%.1f%%",
+             numa->allocations > 0 ? (double)numa->remote_allocations / numa->allocations * 100.0 : 0.0);
+    snprintf(cost_str, sizeof(cost_str), "%.2f",
+             numa->placed_size > 0 ? numa->weighted_cost / numa->placed_size / NUMA_LOCAL_DISTANCE : 0.0);
+
+    printf("%-12s %-12s %-9s %-8s %-7s", get_strategy_name(strategy), get_numa_policy_name(numa->policy),
+           success_str, remote_str, cost_str);
+    for (int n = 0; n < numa->node_count; n++)
+    {
+        printf(" N%d %2.0f/%3.0f%%", n,
+               numa->utilization_sum[n] / (numa->utilization_samples > 0 ? numa->utilization_samples : 1) * 100.0,
+               numa->peak_utilization[n] * 100.0);
+    }
+    printf("\n");
+}
+
+/**
+ * NUMA mode: compare placement policies on every fit strategy
+ *
+ * Memory is split into equal nodes. BENCH_SLOTS process slots run on CPUs
+ * spread round-robin over the nodes (slot % nodes is the home node); each
+ * operation frees a random running slot or requests the size of a random
+ * input process for an idle one. The seed is fixed, so every strategy and
+ * policy sees the same requests.
+ */
+void run_numa_simulation(Process processes[], int num_processes)
+{
+    AllocationStrategy strategies[NUM_STRATEGIES] = {FIRST_FIT, BEST_FIT, WORST_FIT, BITMAP_FIT};
+    int first = sim_options.numa_compare_all ? 0 : (int)sim_options.numa_policy;
+    int last = sim_options.numa_compare_all ? NUM_NUMA_POLICIES - 1 : first;
+    int node_count = sim_options.numa_nodes;
+
+    printf("\n===== NUMA PLACEMENT SIMULATION =====\n");
+    printf("%d nodes of about %lld %s, %d operations, %d process slots, seed %d\n",
+           node_count, memory_size / node_count, get_unit_name(), BENCH_OPERATIONS, BENCH_SLOTS, BENCH_SEED);
+
+    bool printed_distances = false;
+    for (int s = 0; s < NUM_STRATEGIES; s++)
+    {
+        for (int policy = first; policy <= last; policy++)
+        {
+            NumaSystem numa;
+            numa_init(&numa, node_count, strategies[s], (NumaPolicy)policy);
+            if (sim_options.numa_distance_file != NULL && !numa_load_distances(&numa, sim_options.numa_distance_file))
+            {
+                numa_destroy(&numa);
+                return;
+            }
+
+            if (!printed_distances)
+            {
+                printf("Node distances:\n");
+                for (int i = 0; i < node_count; i++)
+                {
+                    printf("  N%d:", i);
+                    for (int j = 0; j < node_count; j++)
+                        printf(" %3d", numa.distance[i][j]);
+                    printf("\n");
+                }
+                printf("\n%-12s %-12s %-9s %-8s %-7s %s\n", "Strategy", "Policy", "Success", "Remote", "Cost",
+                       "Node utilization (avg/peak)");
+                printf("------------------------------------------------------------------------------------------------\n");
+                printed_distances = true;
+            }
+
+            Process node_processes[MAX_NUMA_NODES][BENCH_SLOTS];
+            int slot_node[BENCH_SLOTS];
+            for (int n = 0; n < node_count; n++)
+            {
+                for (int i = 0; i < BENCH_SLOTS; i++)
+                {
+                    node_processes[n][i].id = i + 1;
+                    node_processes[n][i].size = 0;
+                    node_processes[n][i].state = PROCESS_NEW;
+                    node_processes[n][i].block_index = -1;
+                }
+                numa.nodes[n].process_table = node_processes[n];
+                numa.nodes[n].process_count = BENCH_SLOTS;
+            }
+            for (int i = 0; i < BENCH_SLOTS; i++)
+            {
+                slot_node[i] = -1;
+            }
+
+            Statistics stats = {0};
+            srand(BENCH_SEED);
+            for (int op = 0; op < BENCH_OPERATIONS; op++)
+            {
+                int slot = rand() % BENCH_SLOTS;
+
+                if (slot_node[slot] >= 0)
+                {
+                    numa_deallocate(&numa, node_processes, slot, slot_node[slot]);
+                    slot_node[slot] = -1;
+                }
+                else
+                {
+                    Process request = processes[rand() % num_processes];
+                    request.id = slot + 1;
+
+                    stats.allocation_attempts++;
+                    slot_node[slot] = numa_allocate(&numa, node_processes, slot, &request, slot % node_count);
+                    if (slot_node[slot] >= 0)
+                        stats.successful_allocations++;
+                    else
+                        stats.failed_allocations++;
+                }
+                numa_sample(&numa);
+            }
+
+            print_numa_report(&numa, strategies[s], &stats);
+            numa_destroy(&numa);
+        }
+    }
+}
+
+/**
+ * Get the display name of a lifetime policy
+ */
+const char *get_lifetime_policy_name(LifetimePolicy policy)
+{
+    switch (policy)
+    {
+    case LIFETIME_OFF:
+        return "Off";
+    case LIFETIME_ORACLE:
+        return "Oracle";
+    case LIFETIME_PREDICTED:
+        return "Predicted";
+    default:
+        return "Unknown";
+    }
+}
+
+/**
+ * Create an untrained lifetime classifier
+ */
+LifetimeModel *lifetime_create(LifetimePolicy policy)
+{
+    LifetimeModel *model = calloc(1, sizeof(LifetimeModel));
+    if (model == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate lifetime model\n");
+        exit(EXIT_FAILURE);
+    }
+
+    model->policy = policy;
+    return model;
+}
+
+/**
+ * Free a lifetime classifier
+ */
+void lifetime_destroy(LifetimeModel *model)
+{
+    free(model);
+}
+
+/**
+ * Power-of-two size class of a request
+ */
+static int lifetime_size_class(MemSize size)
+{
+    int size_class = 0;
+    while (size > 1 && size_class < LIFETIME_SIZE_CLASSES - 1)
+    {
+        size >>= 1;
+        size_class++;
+    }
+    return size_class;
+}
+
+/**
+ * qsort comparator: processes by arrival tick, then ID
+ */
+static int compare_arrivals(const void *a, const void *b)
+{
+    const Process *x = (const Process *)a;
+    const Process *y = (const Process *)b;
+
+    if (x->arrival_time != y->arrival_time)
+        return x->arrival_time < y->arrival_time ? -1 : 1;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+/**
+ * Learn the long-lived threshold and per-size-class lifetimes from a workload
+ *
+ * Only the first LIFETIME_TRAINING_PERCENT of requests, in arrival order,
+ * are looked at. The threshold is their mean Duration, which falls between
+ * the modes of the usual short/long mix. The predictor
+ * remembers their mean Duration per power-of-two size class, since the size
+ * is all an allocator knows about a request when it arrives. A prefix of
+ * fewer than LIFETIME_MIN_SAMPLES requests leaves the model untrained.
+ */
+void lifetime_train(LifetimeModel *model, const Process processes[], int num_processes)
+{
+    model->trained = false;
+    model->short_requests = 0;
+    model->long_requests = 0;
+    model->mispredictions = 0;
+    memset(model->class_duration, 0, sizeof(model->class_duration));
+    memset(model->class_samples, 0, sizeof(model->class_samples));
+
+    if (num_processes <= 0)
+    {
+        return;
+    }
+
+    int prefix = num_processes * LIFETIME_TRAINING_PERCENT / 100;
+    if (prefix < LIFETIME_MIN_SAMPLES)
+    {
+        return;
+    }
+
+    Process *ordered = malloc(sizeof(Process) * (size_t)num_processes);
+    if (ordered == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate lifetime training data\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(ordered, processes, sizeof(Process) * (size_t)num_processes);
+    qsort(ordered, (size_t)num_processes, sizeof(Process), compare_arrivals);
+
+    long long duration_sum = 0;
+    for (int i = 0; i < prefix; i++)
+    {
+        int size_class = lifetime_size_class(ordered[i].size);
+        duration_sum += ordered[i].duration;
+        model->class_duration[size_class] += ordered[i].duration;
+        model->class_samples[size_class]++;
+    }
+    for (int c = 0; c < LIFETIME_SIZE_CLASSES; c++)
+    {
+        if (model->class_samples[c] > 0)
+            model->class_duration[c] /= model->class_samples[c];
+    }
+
+    model->threshold = (int)(duration_sum / prefix);
+    model->prefix_arrival = ordered[prefix - 1].arrival_time;
+    model->prefix_id = ordered[prefix - 1].id;
+    model->trained = true;
+
+    free(ordered);
+}
+
+/**
+ * Classify a request as long-lived (placed from the top) or short-lived
+ *
+ * Unseen size classes are predicted at the threshold, i.e. short-lived.
+ * Untrained models classify everything as short-lived. Requests in the
+ * training prefix are placed from the bottom and not counted, so the class
+ * sizes and mispredictions only cover requests the model has not seen.
+ *
+ * A request is classified once. Queue retries and swap-ins place it again,
+ * and reuse the class cached on the process without counting it twice.
+ */
+bool is_long_lived(LifetimeModel *model, Process *process)
+{
+    if (!model->trained)
+    {
+        return false;
+    }
+    if (process->lifetime_class != LIFETIME_UNCLASSIFIED)
+    {
+        return process->lifetime_class == LIFETIME_LONG;
+    }
+
+    if (process->arrival_time < model->prefix_arrival ||
+        (process->arrival_time == model->prefix_arrival && process->id <= model->prefix_id))
+    {
+        process->lifetime_class = LIFETIME_SHORT;
+        return false;
+    }
+
+    bool actual = process->duration > model->threshold;
+    bool predicted = actual;
+
+    if (model->policy == LIFETIME_PREDICTED)
+    {
+        int size_class = lifetime_size_class(process->size);
+        double expected = model->class_samples[size_class] > 0 ? model->class_duration[size_class] : model->threshold;
+        predicted = expected > model->threshold;
+        if (predicted != actual)
+            model->mispredictions++;
+    }
+
+    if (predicted)
+        model->long_requests++;
+    else
+        model->short_requests++;
+    process->lifetime_class = predicted ? LIFETIME_LONG : LIFETIME_SHORT;
+    return predicted;
+}
+
+/**
+ * qsort comparator: replay events by tick, then phase, then process
+ *
+ * Within a tick, blocks that are due are freed before new requests arrive;
+ * a process with zero duration is freed right after its own arrival.
+ */
+int compare_replay_events(const void *a, const void *b)
+{
+    const ReplayEvent *x = (const ReplayEvent *)a;
+    const ReplayEvent *y = (const ReplayEvent *)b;
+
+    if (x->time != y->time)
+        return x->time < y->time ? -1 : 1;
+    if (x->phase != y->phase)
+        return x->phase - y->phase;
+    return x->process - y->process;
+}
+
+/**
+ * Replay a workload on its timeline
+ *
+ * Each process arrives at arrival_time, holds its block for duration ticks
+ * and is then freed. External fragmentation is sampled at every arrival, and
+ * failures that happened although enough total memory was free are counted
+ * separately: those are the ones the placement strategy is to blame for.
+ */
+void replay_workload(MemoryManager *manager, Process processes[], int num_processes, Statistics *stats)
+{
+    ReplayEvent *events = malloc(sizeof(ReplayEvent) * 2 * (size_t)(num_processes > 0 ? num_processes : 1));
+    int event_count = 0;
+
+    if (events == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate replay events\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(stats, 0, sizeof(Statistics));
+    manager->process_table = processes;
+    manager->process_count = num_processes;
+    if (manager->lifetime != NULL)
+    {
+        lifetime_train(manager->lifetime, processes, num_processes);
+    }
+
+    for (int i = 0; i < num_processes; i++)
+    {
+        processes[i].state = PROCESS_NEW;
+        processes[i].block_index = -1;
+        processes[i].lifetime_class = LIFETIME_UNCLASSIFIED;
+
+        events[event_count].time = processes[i].arrival_time;
+        events[event_count].phase = 1;
+        events[event_count].process = i;
+        event_count++;
+
+        events[event_count].time = processes[i].arrival_time + processes[i].duration;
+        events[event_count].phase = processes[i].duration > 0 ? 0 : 2;
+        events[event_count].process = i;
+        event_count++;
+    }
+    qsort(events, (size_t)event_count, sizeof(ReplayEvent), compare_replay_events);
+
+    for (int e = 0; e < event_count; e++)
+    {
+        Process *process = &processes[events[e].process];
+
+        if (events[e].phase != 1)
+        {
+            if (process->state == PROCESS_RUNNING || process->state == PROCESS_SWAPPED)
+            {
+                deallocate_memory(manager, process);
+            }
+            continue;
+        }
+
+        bool enough_free = round_request_size(manager, process->size) <= manager->free_size;
+        stats->allocation_attempts++;
+        if (allocate_memory(manager, process))
+        {
+            stats->successful_allocations++;
+        }
+        else
+        {
+            stats->failed_allocations++;
+            if (enough_free)
+                stats->fragmented_failures++;
+        }
+
+        record_utilization(manager, stats);
+        update_fragmentation_metrics(manager, processes, num_processes, stats);
+        stats->fragmentation_sum += stats->fragmentation_percentage;
+        stats->fragmentation_samples++;
+    }
+    free(events);
+}
+
+/**
+ * Replay a workload under one strategy, with or without lifetime segregation
+ *
+ * The replayed processes are reset afterwards, so the caller's table can be
+ * replayed again. With segregation, the trained model is copied to model.
+ */
+static void replay_with_strategy(Process processes[], int num_processes, AllocationStrategy strategy,
+                                 bool segregate, Statistics *stats, LifetimeModel *model)
+{
+    MemoryManager manager;
+    initialize_memory_manager(&manager, strategy);
+    manager.verbose = false;
+    if (!segregate)
+    {
+        lifetime_destroy(manager.lifetime);
+        manager.lifetime = NULL;
+    }
+
+    replay_workload(&manager, processes, num_processes, stats);
+    if (segregate && manager.lifetime != NULL)
+    {
+        *model = *manager.lifetime;
+    }
+    destroy_memory_manager(&manager);
+
+    for (int i = 0; i < num_processes; i++)
+    {
+        processes[i].state = PROCESS_NEW;
+        processes[i].block_index = -1;
+    }
+}
+
+/**
+ * Replay the workload under every strategy and print one row each
+ *
+ * With --lifetime, a second table compares each block-list fit with and
+ * without lifetime segregation.
+ */
+void print_replay_table(Process processes[], int num_processes)
+{
+    AllocationStrategy strategies[NUM_STRATEGIES] = {FIRST_FIT, BEST_FIT, WORST_FIT, BITMAP_FIT};
+    Statistics plain[NUM_STRATEGIES];
+
+    printf("\n=== Timeline Replay (%d processes, %lld %s) ===\n", num_processes, memory_size, get_unit_name());
+    printf("%-12s %-10s %-8s %-14s %-12s %-10s\n",
+           "Strategy", "Success", "Failed", "Frag Failures", "Mean Frag", "Peak Util");
+    printf("----------------------------------------------------------------------\n");
+
+    for (int s = 0; s < NUM_STRATEGIES; s++)
+    {
+        Statistics *stats = &plain[s];
+        replay_with_strategy(processes, num_processes, strategies[s], false, stats, NULL);
+
+        char success_str[20], frag_str[20], peak_str[20];
+        sprintf(success_str, "%.1f%%", stats->allocation_attempts > 0 ? (double)stats->successful_allocations / stats->allocation_attempts * 100.0 : 0.0);
+        sprintf(frag_str, "%.1f%%", stats->fragmentation_samples > 0 ? stats->fragmentation_sum / stats->fragmentation_samples : 0.0);
+        sprintf(peak_str, "%.1f%%", stats->peak_utilization * 100.0);
+        printf("%-12s %-10s %-8d %-14d %-12s %-10s\n",
+               get_strategy_name(strategies[s]), success_str, stats->failed_allocations,
+               stats->fragmented_failures, frag_str, peak_str);
+    }
+
+    if (sim_options.lifetime_policy == LIFETIME_OFF)
+    {
+        return;
+    }
+
+    // Bitmap Fit never segregates, so only the block-list fits are compared
+    bool header_printed = false;
+    for (int s = 0; s < NUM_STRATEGIES; s++)
+    {
+        if (strategies[s] == BITMAP_FIT)
+        {
+            continue;
+        }
+
+        Statistics segregated;
+        LifetimeModel model = {0};
+        replay_with_strategy(processes, num_processes, strategies[s], true, &segregated, &model);
+
+        if (!header_printed)
+        {
+            if (model.trained)
+                printf("\n=== Lifetime Segregation (%s, long-lived above %d ticks) ===\n",
+                       get_lifetime_policy_name(model.policy), model.threshold);
+            else
+                printf("\n=== Lifetime Segregation (%s, untrained: fewer than %d requests in the first %d%%) ===\n",
+                       get_lifetime_policy_name(model.policy), LIFETIME_MIN_SAMPLES, LIFETIME_TRAINING_PERCENT);
+            printf("%-12s %-10s %-16s %-18s %-6s %-6s %-12s\n",
+                   "Strategy", "Failed", "Frag Failures", "Mean Frag", "Short", "Long", "Mispredicted");
+            printf("---------------------------------------------------------------------------------------\n");
+            header_printed = true;
+        }
+
+        char failed_str[24], frag_failed_str[24], frag_str[32];
+        snprintf(failed_str, sizeof(failed_str), "%d -> %d", plain[s].failed_allocations, segregated.failed_allocations);
+        snprintf(frag_failed_str, sizeof(frag_failed_str), "%d -> %d", plain[s].fragmented_failures, segregated.fragmented_failures);
+        snprintf(frag_str, sizeof(frag_str), "%.1f%% -> %.1f%%",
+                 plain[s].fragmentation_samples > 0 ? plain[s].fragmentation_sum / plain[s].fragmentation_samples : 0.0,
+                 segregated.fragmentation_samples > 0 ? segregated.fragmentation_sum / segregated.fragmentation_samples : 0.0);
+        printf("%-12s %-10s %-16s %-18s %-6d %-6d %-12d\n",
+               get_strategy_name(strategies[s]), failed_str, frag_failed_str, frag_str,
+               model.short_requests, model.long_requests, model.mispredictions);
+    }
+}
+
+/**
+ * Command-line name of a strategy, used in default trace file names
+ */
+const char *get_search_strategy_key(AllocationStrategy strategy)
+{
+    switch (strategy)
+    {
+    case FIRST_FIT:
+        return "first";
+    case BEST_FIT:
+        return "best";
+    case WORST_FIT:
+        return "worst";
+    case BITMAP_FIT:
+        return "bitmap";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * Replay one candidate under every strategy and score it against the target
+ *
+ * The score is the target's objective minus that of the best other strategy,
+ * so a workload only scores high if it hurts the target specifically, not
+ * one that overloads memory for everyone. The secondary metric breaks ties,
+ * so a search for failures still prefers the more fragmented of two equally
+ * failing workloads and vice versa.
+ */
+void evaluate_candidate(SearchCandidate *candidate, AllocationStrategy strategy, SearchObjective objective)
+{
+    AllocationStrategy strategies[NUM_STRATEGIES] = {FIRST_FIT, BEST_FIT, WORST_FIT, BITMAP_FIT};
+    double target_value = 0.0, rival_value = 0.0;
+    bool have_rival = false;
+
+    for (int s = 0; s < NUM_STRATEGIES; s++)
+    {
+        MemoryManager manager;
+        Statistics stats;
+
+        initialize_memory_manager(&manager, strategies[s]);
+        manager.verbose = false;
+        replay_workload(&manager, candidate->processes, candidate->count, &stats);
+        destroy_memory_manager(&manager);
+
+        double failure_rate = stats.allocation_attempts > 0
+                                  ? (double)stats.fragmented_failures / stats.allocation_attempts * 100.0
+                                  : 0.0;
+        double fragmentation = stats.fragmentation_samples > 0
+                                   ? stats.fragmentation_sum / stats.fragmentation_samples
+                                   : 0.0;
+        double value = objective == SEARCH_FAILURES
+                           ? failure_rate + fragmentation / 1000.0
+                           : fragmentation + failure_rate / 1000.0;
+
+        if (strategies[s] == strategy)
+        {
+            candidate->failure_rate = failure_rate;
+            candidate->mean_fragmentation = fragmentation;
+            target_value = value;
+        }
+        else if (!have_rival || value < rival_value)
+        {
+            candidate->rival = strategies[s];
+            candidate->rival_failure_rate = failure_rate;
+            candidate->rival_fragmentation = fragmentation;
+            rival_value = value;
+            have_rival = true;
+        }
+    }
+
+    candidate->score = target_value - rival_value;
+}
+
+/**
+ * Evaluate unclaimed candidates of the current generation until none are left
+ *
+ * Called with pool->lock held; the lock is released around each chunk, so
+ * threads that finish early keep claiming work.
+ */
+static void search_pool_drain(SearchPool *pool)
+{
+    while (pool->next < pool->count)
+    {
+        int first = pool->next;
+        int last = first + SEARCH_CHUNK < pool->count ? first + SEARCH_CHUNK : pool->count;
+        pool->next = last;
+
+        pthread_mutex_unlock(&pool->lock);
+        for (int i = first; i < last; i++)
+        {
+            evaluate_candidate(&pool->candidates[i], pool->strategy, pool->objective);
+        }
+        pthread_mutex_lock(&pool->lock);
+    }
+}
+
+/**
+ * Thread body: evaluate chunks of every generation until the pool stops
+ *
+ * Each evaluation owns its managers and candidate; the globals it reads
+ * (memory_size, sim_options) are fixed before the threads start.
+ */
+void *search_worker(void *arg)
+{
+    SearchPool *pool = (SearchPool *)arg;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true)
+    {
+        while (!pool->stopping && pool->generation == seen)
+        {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->stopping)
+        {
+            break;
+        }
+        seen = pool->generation;
+
+        search_pool_drain(pool);
+        if (--pool->busy == 0)
+        {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * Start the evaluation threads; the calling thread is the first of them
+ */
+void search_pool_start(SearchPool *pool, int threads, AllocationStrategy strategy, SearchObjective objective)
+{
+    memset(pool, 0, sizeof(SearchPool));
+    pool->strategy = strategy;
+    pool->objective = objective;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    for (int t = 1; t < threads; t++)
+    {
+        if (pthread_create(&pool->workers[pool->worker_count], NULL, search_worker, pool) != 0)
+        {
+            fprintf(stderr, "Error: Could not start search thread\n");
+            exit(EXIT_FAILURE);
+        }
+        pool->worker_count++;
+    }
+}
+
+/**
+ * Stop and join the evaluation threads
+ */
+void search_pool_stop(SearchPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int t = 0; t < pool->worker_count; t++)
+    {
+        pthread_join(pool->workers[t], NULL);
+    }
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/**
+ * Evaluate a generation on the pool's threads and the calling thread
+ *
+ * Threads claim SEARCH_CHUNK candidates at a time, so uneven replay costs
+ * balance out. The call returns once every worker has finished.
+ */
+void evaluate_generation(SearchPool *pool, SearchCandidate candidates[], int count)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->candidates = candidates;
+    pool->count = count;
+    pool->next = 0;
+    pool->busy = pool->worker_count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    search_pool_drain(pool);
+    while (pool->busy > 0)
+    {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Apply one random change to a workload
+ */
+void mutate_candidate(SearchCandidate *candidate, uint64_t *rng)
+{
+    MemSize max_size = memory_size / 2 > 1 ? memory_size / 2 : 1;
+    Process *process = &candidate->processes[xorshift_random(rng) % (uint64_t)candidate->count];
+
+    switch (xorshift_random(rng) % 5)
+    {
+    case 0: // Scale the size by 0.5x to 2x
+        process->size = process->size * (MemSize)(50 + xorshift_random(rng) % 151) / 100;
+        break;
+    case 1: // Draw a new size
+        process->size = 1 + (MemSize)(xorshift_random(rng) % (uint64_t)max_size);
+        break;
+    case 2: // Move the arrival
+        process->arrival_time += (int)(xorshift_random(rng) % 21) - 10;
+        break;
+    case 3: // Stretch or shrink the lifetime
+        process->duration += (int)(xorshift_random(rng) % 21) - 10;
+        break;
+    default: // Swap sizes with another process
+    {
+        Process *other = &candidate->processes[xorshift_random(rng) % (uint64_t)candidate->count];
+        MemSize size = process->size;
+        process->size = other->size;
+        other->size = size;
+        break;
+    }
+    }
+
+    if (process->size < 1)
+        process->size = 1;
+    if (process->size > max_size)
+        process->size = max_size;
+    if (process->arrival_time < 0)
+        process->arrival_time = 0;
+    if (process->arrival_time > SEARCH_HORIZON)
+        process->arrival_time = SEARCH_HORIZON;
+    if (process->duration < 0)
+        process->duration = 0;
+    if (process->duration > SEARCH_HORIZON)
+        process->duration = SEARCH_HORIZON;
+}
+
+/**
+ * Copy a workload and its scores into another candidate's process slice
+ */
+void copy_candidate(SearchCandidate *target, const SearchCandidate *source)
+{
+    Process *processes = target->processes;
+
+    *target = *source;
+    target->processes = processes;
+    memcpy(processes, source->processes, sizeof(Process) * (size_t)source->count);
+}
+
+/**
+ * One-point crossover: the child takes a's processes up to a random cut, b's after
+ */
+void crossover_candidates(const SearchCandidate *a, const SearchCandidate *b, SearchCandidate *child, uint64_t *rng)
+{
+    int cut = (int)(xorshift_random(rng) % (uint64_t)a->count);
+
+    copy_candidate(child, a);
+    memcpy(&child->processes[cut], &b->processes[cut], sizeof(Process) * (size_t)(a->count - cut));
+}
+
+/**
+ * qsort comparator: highest score (worst workload) first
+ */
+int compare_candidates(const void *a, const void *b)
+{
+    double x = ((const SearchCandidate *)a)->score;
+    double y = ((const SearchCandidate *)b)->score;
+    return (x < y) - (x > y);
+}
+
+/**
+ * Write a workload in the input file format
+ */
+bool write_workload(const char *filename, const SearchCandidate *candidate, const char *comment)
+{
+    FILE *file = fopen(filename, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: Could not write trace file '%s'\n", filename);
+        return false;
+    }
+
+    fprintf(file, "%lld\n", memory_size);
+    fprintf(file, "# %s\n", comment);
+    fprintf(file, "# ID Size Arrival Duration\n");
+    for (int i = 0; i < candidate->count; i++)
+    {
+        const Process *process = &candidate->processes[i];
+        fprintf(file, "%d %lld %d %d\n", process->id, process->size, process->arrival_time, process->duration);
+    }
+
+    return fclose(file) == 0;
+}
+
+/**
+ * Search for workloads that make one strategy fragment or fail
+ *
+ * A (mu + lambda) genetic algorithm over timed workloads of the input's
+ * length and memory size: each generation breeds SEARCH_POPULATION children
+ * by tournament selection, optional one-point crossover and one to three
+ * mutations, evaluates them in parallel, and keeps the best of parents and
+ * children. A workload's score is how much worse the target does on it than
+ * the best other strategy. The input workload seeds the population. The
+ * random stream is only used on the calling thread, so results do not depend
+ * on --threads.
+ */
+void run_adversarial_search(Process processes[], int num_processes)
+{
+    AllocationStrategy strategy = sim_options.search_strategy;
+    SearchObjective objective = sim_options.search_objective;
+    const char *objective_name = objective == SEARCH_FAILURES ? "fragmented failures" : "mean fragmentation";
+    int threads = sim_options.threads;
+    uint64_t rng = SEARCH_SEED;
+
+    // By default use the cores, but leave every thread a few candidates: a
+    // generation is small, and a thread with nothing to claim only adds wakeups
+    if (threads == 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cores > 0 ? (int)cores : 1;
+        if (threads > SEARCH_POPULATION / SEARCH_MIN_PER_THREAD)
+            threads = SEARCH_POPULATION / SEARCH_MIN_PER_THREAD;
+    }
+    if (threads > SEARCH_POPULATION)
+        threads = SEARCH_POPULATION;
+    if (threads > MAX_SEARCH_THREADS)
+        threads = MAX_SEARCH_THREADS;
+
+    // Each candidate owns one slice of a shared process pool; sorting the
+    // population swaps the slices along with the candidates
+    SearchCandidate *population = malloc(sizeof(SearchCandidate) * 2 * SEARCH_POPULATION);
+    Process *slices = malloc(sizeof(Process) * 2 * SEARCH_POPULATION * (size_t)num_processes);
+    if (population == NULL || slices == NULL)
+    {
+        fprintf(stderr, "Error: Could not allocate search population\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int c = 0; c < 2 * SEARCH_POPULATION; c++)
+    {
+        population[c].processes = &slices[(size_t)c * num_processes];
+    }
+
+    // Parents live in the first half, children in the second
+    MemSize max_size = memory_size / 2 > 1 ? memory_size / 2 : 1;
+    for (int c = 0; c < SEARCH_POPULATION; c++)
+    {
+        SearchCandidate *candidate = &population[c];
+        candidate->count = num_processes;
+        memcpy(candidate->processes, processes, sizeof(Process) * (size_t)num_processes);
+        for (int i = 0; c > 0 && i < num_processes; i++)
+        {
+            candidate->processes[i].size = 1 + (MemSize)(xorshift_random(&rng) % (uint64_t)max_size);
+            candidate->processes[i].arrival_time = (int)(xorshift_random(&rng) % (SEARCH_HORIZON + 1));
+            candidate->processes[i].duration = 1 + (int)(xorshift_random(&rng) % SEARCH_HORIZON);
+        }
+    }
+
+    printf("\n=== Adversarial Search: %s, maximizing its lead in %s over the best other strategy ===\n",
+           get_strategy_name(strategy), objective_name);
+    printf("%d processes, %lld %s, population %d, %d generations, %d threads\n\n",
+           num_processes, memory_size, get_unit_name(), SEARCH_POPULATION, sim_options.search_generations, threads);
+
+    SearchPool pool;
+    search_pool_start(&pool, threads, strategy, objective);
+    evaluate_generation(&pool, population, SEARCH_POPULATION);
+    double input_score = population[0].score;
+    qsort(population, SEARCH_POPULATION, sizeof(SearchCandidate), compare_candidates);
+
+    int report_every = sim_options.search_generations >= 10 ? sim_options.search_generations / 10 : 1;
+    long long start = now_ns();
+    for (int g = 1; g <= sim_options.search_generations; g++)
+    {
+        for (int c = 0; c < SEARCH_POPULATION; c++)
+        {
+            SearchCandidate *child = &population[SEARCH_POPULATION + c];
+
+            // Binary tournaments pick the parents
+            int a = (int)(xorshift_random(&rng) % SEARCH_POPULATION);
+            int b = (int)(xorshift_random(&rng) % SEARCH_POPULATION);
+            const SearchCandidate *parent = &population[a < b ? a : b];
+
+            if (xorshift_random(&rng) % 100 < SEARCH_CROSSOVER_PERCENT)
+            {
+                int d = (int)(xorshift_random(&rng) % SEARCH_POPULATION);
+                int e = (int)(xorshift_random(&rng) % SEARCH_POPULATION);
+                crossover_candidates(parent, &population[d < e ? d : e], child, &rng);
+            }
+            else
+            {
+                copy_candidate(child, parent);
+            }
+
+            int mutations = 1 + (int)(xorshift_random(&rng) % 3);
+            for (int m = 0; m < mutations; m++)
+            {
+                mutate_candidate(child, &rng);
+            }
+        }
+
+        evaluate_generation(&pool, &population[SEARCH_POPULATION], SEARCH_POPULATION);
+        qsort(population, 2 * SEARCH_POPULATION, sizeof(SearchCandidate), compare_candidates);
+
+        if (g % report_every == 0 || g == sim_options.search_generations)
+        {
+            printf("Generation %-5d worst: %.1f%% fragmented failures, %.1f%% mean fragmentation"
+                   " (best other, %s: %.1f%%, %.1f%%)\n",
+                   g, population[0].failure_rate, population[0].mean_fragmentation,
+                   get_strategy_name(population[0].rival), population[0].rival_failure_rate,
+                   population[0].rival_fragmentation);
+        }
+    }
+    double elapsed = (double)(now_ns() - start) / 1e9;
+    search_pool_stop(&pool);
+
+    printf("\nInput workload scored %.3f, worst found %.3f (%.0f workloads/s)\n",
+           input_score, population[0].score,
+           elapsed > 0 ? (double)sim_options.search_generations * SEARCH_POPULATION / elapsed : 0.0);
+
+    // Write the worst traces so they can be replayed as regression benchmarks
+    char default_prefix[32];
+    snprintf(default_prefix, sizeof(default_prefix), "worst_%s", get_search_strategy_key(strategy));
+    const char *prefix = sim_options.search_output != NULL ? sim_options.search_output : default_prefix;
+
+    for (int k = 0; k < SEARCH_KEEP && k < SEARCH_POPULATION; k++)
+    {
+        char filename[512], comment[320];
+        snprintf(filename, sizeof(filename), "%s_%d.txt", prefix, k + 1);
+        snprintf(comment, sizeof(comment),
+                 "Adversarial workload #%d for %s: %.1f%% fragmented failures, %.1f%% mean fragmentation; "
+                 "best other %s: %.1f%%, %.1f%%",
+                 k + 1, get_strategy_name(strategy), population[k].failure_rate, population[k].mean_fragmentation,
+                 get_strategy_name(population[k].rival), population[k].rival_failure_rate,
+                 population[k].rival_fragmentation);
+        if (write_workload(filename, &population[k], comment))
+        {
+            printf("Wrote %s\n", filename);
+        }
+    }
+
+    // How specific is the pathology? Replay the worst trace under every strategy
+    print_replay_table(population[0].processes, population[0].count);
+    free(slices);
+    free(population);
+}
+
+/**
+ * Random request size in [0, limit), wide enough for byte-granular TB pools
+ */
+static MemSize bench_random(MemSize limit)
+{
+    if (limit <= RAND_MAX)
+    {
+        return rand() % limit;
+    }
+    return (((MemSize)rand() << 31) ^ rand()) % limit;
+}
+
+/**
+ * Benchmark all strategies on a synthetic allocate/free workload
+ *
+ * Each run keeps BENCH_SLOTS processes; every operation picks a slot at random
+ * and either frees it (if running) or allocates a new random size into it.
+ * The same seed is used for every strategy so they see the same requests.
+ */
+void run_benchmark(void)
+{
+    static const MemSize bench_memory_bytes[] = {1LL << 20, 1LL << 30, 1LL << 40};
+    static const char *bench_memory_labels[] = {"1 MB", "1 GB", "1 TB"};
+    AllocationStrategy strategies[NUM_STRATEGIES] = {FIRST_FIT, BEST_FIT, WORST_FIT, BITMAP_FIT};
+    int num_sizes = sizeof(bench_memory_bytes) / sizeof(bench_memory_bytes[0]);
+
+    printf("\n===== ALLOCATION STRATEGY BENCHMARK =====\n");
+    printf("%d operations per run, %d process slots, seed %d, %s coalescing, %d-byte units\n\n",
+           BENCH_OPERATIONS, BENCH_SLOTS, BENCH_SEED, get_coalesce_policy_name(sim_options.coalesce_policy),
+           allocation_unit);
+    printf("%-12s %-8s %-10s %-12s %-16s %-8s %-8s %-8s %-10s\n",
+           "Strategy", "Memory", "Success", "Ext Frag", "Internal Frag", "Blocks", "Merges", "Reuses", "ns/op");
+    printf("------------------------------------------------------------------------------------------------\n");
+
+    for (int m = 0; m < num_sizes; m++)
+    {
+        // The extra run is the adaptive mode, starting out as First Fit
+        for (int s = 0; s <= NUM_STRATEGIES; s++)
+        {
+            memory_size = bench_memory_bytes[m] / allocation_unit;
+
+            MemoryManager manager;
+            initialize_memory_manager(&manager, s < NUM_STRATEGIES ? strategies[s] : FIRST_FIT);
+            manager.verbose = false;
+
+            Process slots[BENCH_SLOTS];
+            for (int i = 0; i < BENCH_SLOTS; i++)
+            {
+                slots[i].id = i + 1;
+                slots[i].size = 0;
+                slots[i].state = PROCESS_NEW;
+                slots[i].block_index = -1;
+            }
+            manager.process_table = slots;
+            manager.process_count = BENCH_SLOTS;
+            if (s == NUM_STRATEGIES)
+            {
+                adaptive_create(&manager);
+            }
+
+            Statistics stats = {0};
+            MemSize max_request = memory_size / (BENCH_SLOTS / 2);
+            srand(BENCH_SEED);
+
+            clock_t start = clock();
+            for (int op = 0; op < BENCH_OPERATIONS; op++)
+            {
+                if (sim_options.map_interval > 0 && op > 0 && op % sim_options.map_interval == 0)
+                {
+                    // Not counted in the timing
+                    clock_t pause = clock();
+                    printf("  %s, %s, after %d operations:", get_manager_name(&manager), bench_memory_labels[m], op);
+                    print_memory_map(&manager, MEM_VISUAL_SIZE);
+                    start += clock() - pause;
+                }
+
+                Process *process = &slots[rand() % BENCH_SLOTS];
+
+                if (process->state == PROCESS_RUNNING || process->state == PROCESS_SWAPPED)
+                {
+                    deallocate_memory(&manager, process);
+                    continue;
+                }
+                if (process->state == PROCESS_WAITING)
+                {
+                    // Its request is still queued
+                    continue;
+                }
+
+                process->size = 1 + bench_random(max_request);
+                process->state = PROCESS_NEW;
+                stats.allocation_attempts++;
+                if (admit_request(&manager, process))
+                    stats.successful_allocations++;
+                else
+                    stats.failed_allocations++;
+            }
+            double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+            update_fragmentation_metrics(&manager, slots, BENCH_SLOTS, &stats);
+
+            char success_str[20], frag_str[20], internal_str[20];
+            sprintf(success_str, "%.1f%%", (double)stats.successful_allocations / stats.allocation_attempts * 100.0);
+            sprintf(frag_str, "%.1f%%", stats.fragmentation_percentage);
+            sprintf(internal_str, "%.3f%%", (double)stats.internal_fragmentation / manager.total_size * 100.0);
+
+            printf("%-12s %-8s %-10s %-12s %-16s %-8d %-8d %-8d %-10.0f\n",
+                   get_manager_name(&manager),
+                   bench_memory_labels[m],
+                   success_str,
+                   frag_str,
+                   internal_str,
+                   manager.block_count,
+                   stats.merge_count,
+                   stats.quick_reuse_hits,
+                   elapsed * 1e9 / BENCH_OPERATIONS);
+
+            if (manager.adaptive != NULL)
+            {
+                printf("  %d strategy switches, ended as %s",
+                       manager.adaptive->switch_count,
+                       get_strategy_name(manager.strategy));
+                if (manager.adaptive->primary_ns > 0)
+                    printf(", shadows cost %.1fx the primary",
+                           (double)manager.adaptive->shadow_ns / manager.adaptive->primary_ns);
+                printf("\n");
+            }
+            if (manager.queue != NULL)
+            {
+                print_queue_report(manager.queue);
+            }
+            if (manager.swap != NULL)
+            {
+                print_swap_report(manager.swap);
+            }
+            if (manager.latency != NULL)
+            {
+                print_latency_report(manager.latency);
+            }
+            destroy_memory_manager(&manager);
+        }
+    }
+    printf("\nInternal Frag is shown as a percentage of total memory.\n");
 }
@@ -0,0 +1,522 @@
+/******************************************************************************
+ * File: memtrace.c
+ *
+ * Purpose:
+ * LD_PRELOAD interposer that records the malloc, calloc, realloc and free
+ * calls of a real program and writes them as a trace the simulator reads:
+ * the peak live memory on the first line, then one "ID Size Arrival Duration"
+ * line per allocation.
+ *
+ * Compilation:
+ * gcc -shared -fPIC -O2 memtrace.c -o libmemtrace.so -ldl -pthread
+ *
+ * Usage:
+ * LD_PRELOAD=./libmemtrace.so MEMTRACE_FILE=trace.txt <program> [args]
+ * ./memory_simulation trace.txt
+ *
+ * Environment:
+ * MEMTRACE_FILE        Output trace; "%p" is replaced by the pid (memtrace.txt)
+ * MEMTRACE_UNIT        Bytes per simulator size unit (1024, matching KB)
+ * MEMTRACE_TICK_NS     Nanoseconds per Arrival/Duration tick (1000000 = 1 ms)
+ * MEMTRACE_MIN_BYTES   Ignore allocations smaller than this (1)
+ * MEMTRACE_MAX_EVENTS  Stop capturing after about this many events (1048576)
+ *
+ *****************************************************************************/
+
+#define _GNU_SOURCE // RTLD_NEXT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <stdint.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
+
+
+
+/* Constants */
+#define CHUNK_EVENTS 4096          // Events per thread buffer chunk
+#define BOOTSTRAP_SIZE 65536       // Static arena for allocations made while resolving symbols
+#define DEFAULT_TRACE_FILE "memtrace.txt"
+#define DEFAULT_UNIT 1024          // Matches the simulator's default KB unit
+#define DEFAULT_TICK_NS 1000000LL  // Arrival and Duration in milliseconds
+#define DEFAULT_MIN_BYTES 1
+#define DEFAULT_MAX_EVENTS (1L << 20)
+#define MAX_PATH_LENGTH 4096
+
+/* Event kinds */
+typedef enum
+{
+    EVENT_ALLOC,
+    EVENT_FREE
+} EventKind;
+
+/* One recorded call */
+typedef struct
+{
+    uint64_t time_ns;  // Monotonic time of the call
+    uintptr_t address; // Block returned by the allocation, or passed to free
+    uint64_t size;     // Requested bytes (allocations only)
+    EventKind kind;
+} TraceEvent;
+
+/* Per-thread event buffer; full chunks stay on the global list until exit */
+typedef struct EventChunk
+{
+    TraceEvent events[CHUNK_EVENTS];
+    int count;               // Events used in this chunk
+    struct EventChunk *next; // Next chunk on the global list
+} EventChunk;
+
+/* Sort key for matching frees to allocations */
+typedef struct
+{
+    uintptr_t address; // Event address
+    size_t index;      // Event position in time order
+} AddressKey;
+
+/* Settings read from the environment */
+typedef struct
+{
+    const char *file;    // Output path, may contain "%p"
+    long long unit;      // Bytes per size unit
+    long long tick_ns;   // Nanoseconds per time tick
+    long long min_bytes; // Smallest allocation recorded
+    uint64_t start_ns;   // Time the capture started
+} TraceConfig;
+
+/* Real allocator, resolved with RTLD_NEXT */
+static void *(*real_malloc)(size_t);
+static void *(*real_calloc)(size_t, size_t);
+static void *(*real_realloc)(void *, size_t);
+static void (*real_free)(void *);
+
+static char bootstrap_arena[BOOTSTRAP_SIZE] __attribute__((aligned(16)));
+static size_t bootstrap_used;
+static volatile bool resolving;   // dlsym may allocate; serve it from the arena
+static volatile bool initialized;
+static volatile bool capturing;   // Cleared at exit or when the event budget runs out
+static uint64_t capture_end_ns;   // Time capturing stopped
+
+static pthread_mutex_t chunk_lock = PTHREAD_MUTEX_INITIALIZER;
+static EventChunk *chunk_list;
+static long event_budget;         // Events left before the capture stops
+static TraceConfig config;
+
+static __thread EventChunk *thread_chunk; // Chunk this thread is filling
+static __thread bool in_hook;              // Allocations made by the tracer itself are not recorded
+
+/* Function prototypes */
+static uint64_t trace_now_ns(void);
+static long long env_number(const char *name, long long fallback);
+static void memtrace_init(void);
+static void *bootstrap_alloc(size_t size);
+static bool is_bootstrap(const void *ptr);
+static void stop_capture(void);
+static void record_event(EventKind kind, const void *address, size_t size);
+static void record_event_at(EventKind kind, const void *address, size_t size, uint64_t time_ns);
+static int compare_by_time(const void *a, const void *b);
+static int compare_by_address(const void *a, const void *b);
+static long long to_units(uint64_t bytes);
+static int to_ticks(uint64_t nanoseconds);
+static void memtrace_finish(void);
+
+/**
+ * Monotonic time in nanoseconds
+ */
+static uint64_t trace_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Read a positive number from the environment, or use the fallback
+ */
+static long long env_number(const char *name, long long fallback)
+{
+    const char *value = getenv(name);
+    if (value == NULL)
+        return fallback;
+
+    long long number = atoll(value);
+    return number > 0 ? number : fallback;
+}
+
+/**
+ * Resolve the real allocator and read the settings
+ *
+ * Runs as a constructor, or earlier from the first hooked call if another
+ * library allocates before our constructor runs.
+ */
+__attribute__((constructor)) static void memtrace_init(void)
+{
+    if (initialized || resolving)
+        return;
+
+    resolving = true;
+    real_malloc = (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc");
+    real_calloc = (void *(*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+    real_realloc = (void *(*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+    real_free = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+    resolving = false;
+
+    if (real_malloc == NULL || real_calloc == NULL || real_realloc == NULL || real_free == NULL)
+    {
+        fprintf(stderr, "Error: memtrace could not resolve the real allocator\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const char *file = getenv("MEMTRACE_FILE");
+    config.file = (file != NULL && file[0] != '\0') ? file : DEFAULT_TRACE_FILE;
+    config.unit = env_number("MEMTRACE_UNIT", DEFAULT_UNIT);
+    config.tick_ns = env_number("MEMTRACE_TICK_NS", DEFAULT_TICK_NS);
+    config.min_bytes = env_number("MEMTRACE_MIN_BYTES", DEFAULT_MIN_BYTES);
+    event_budget = (long)env_number("MEMTRACE_MAX_EVENTS", DEFAULT_MAX_EVENTS);
+    config.start_ns = trace_now_ns();
+
+    initialized = true;
+    capturing = true;
+}
+
+/**
+ * Allocate from the static arena (memory is already zeroed)
+ */
+static void *bootstrap_alloc(size_t size)
+{
+    size_t offset = (bootstrap_used + 15) & ~(size_t)15;
+    if (offset > BOOTSTRAP_SIZE || size > BOOTSTRAP_SIZE - offset)
+        return NULL;
+
+    bootstrap_used = offset + size;
+    return bootstrap_arena + offset;
+}
+
+/**
+ * Whether a pointer came from the static arena
+ */
+static bool is_bootstrap(const void *ptr)
+{
+    const char *p = (const char *)ptr;
+    return p >= bootstrap_arena && p < bootstrap_arena + BOOTSTRAP_SIZE;
+}
+
+/**
+ * Stop recording and remember when
+ */
+static void stop_capture(void)
+{
+    if (capturing)
+    {
+        capture_end_ns = trace_now_ns();
+        capturing = false;
+    }
+}
+
+/**
+ * Append one event, stamped now, to the calling thread's buffer
+ */
+static void record_event(EventKind kind, const void *address, size_t size)
+{
+    record_event_at(kind, address, size, trace_now_ns());
+}
+
+/**
+ * Append one event to the calling thread's buffer
+ *
+ * Only a full chunk takes the global lock, to hand a fresh chunk to the
+ * thread; every other call is a store.
+ */
+static void record_event_at(EventKind kind, const void *address, size_t size, uint64_t time_ns)
+{
+    if (!capturing || in_hook || address == NULL)
+        return;
+    if (kind == EVENT_ALLOC && (long long)size < config.min_bytes)
+        return;
+
+    in_hook = true;
+    if (thread_chunk == NULL || thread_chunk->count == CHUNK_EVENTS)
+    {
+        EventChunk *chunk = NULL;
+        if (__sync_sub_and_fetch(&event_budget, CHUNK_EVENTS) + CHUNK_EVENTS > 0)
+            chunk = real_malloc(sizeof(EventChunk));
+
+        if (chunk == NULL)
+        {
+            stop_capture();
+            in_hook = false;
+            return;
+        }
+
+        chunk->count = 0;
+        pthread_mutex_lock(&chunk_lock);
+        chunk->next = chunk_list;
+        chunk_list = chunk;
+        pthread_mutex_unlock(&chunk_lock);
+        thread_chunk = chunk;
+    }
+
+    TraceEvent *event = &thread_chunk->events[thread_chunk->count];
+    event->time_ns = time_ns;
+    event->address = (uintptr_t)address;
+    event->size = size;
+    event->kind = kind;
+    thread_chunk->count++;
+    in_hook = false;
+}
+
+void *malloc(size_t size)
+{
+    if (!initialized)
+    {
+        if (resolving)
+            return bootstrap_alloc(size);
+        memtrace_init();
+    }
+
+    void *ptr = real_malloc(size);
+    record_event(EVENT_ALLOC, ptr, size);
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    if (!initialized)
+    {
+        if (resolving)
+            return bootstrap_alloc(count * size);
+        memtrace_init();
+    }
+
+    void *ptr = real_calloc(count, size);
+    record_event(EVENT_ALLOC, ptr, count * size);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    // Blocks from the arena move to the real heap; the old size is unknown,
+    // so copy up to the end of the arena
+    if (is_bootstrap(ptr))
+    {
+        void *moved = malloc(size);
+        size_t available = (size_t)(bootstrap_arena + BOOTSTRAP_SIZE - (char *)ptr);
+        if (moved != NULL)
+            memcpy(moved, ptr, size < available ? size : available);
+        return moved;
+    }
+
+    if (!initialized)
+    {
+        if (resolving)
+            return NULL;
+        memtrace_init();
+    }
+
+    // The old block is only freed if the call succeeds (or shrinks to zero),
+    // so the free is recorded afterwards but stamped before the call: a racing
+    // allocation that reuses the address is still ordered after it
+    uint64_t start_ns = trace_now_ns();
+    void *result = real_realloc(ptr, size);
+    if (ptr != NULL && (result != NULL || size == 0))
+        record_event_at(EVENT_FREE, ptr, 0, start_ns);
+    record_event(EVENT_ALLOC, result, size);
+    return result;
+}
+
+void free(void *ptr)
+{
+    if (ptr == NULL || is_bootstrap(ptr))
+        return;
+
+    if (!initialized)
+        memtrace_init();
+
+    record_event(EVENT_FREE, ptr, 0);
+    real_free(ptr);
+}
+
+/**
+ * qsort comparator: events in time order, frees first on ties
+ */
+static int compare_by_time(const void *a, const void *b)
+{
+    const TraceEvent *x = (const TraceEvent *)a;
+    const TraceEvent *y = (const TraceEvent *)b;
+
+    if (x->time_ns != y->time_ns)
+        return x->time_ns < y->time_ns ? -1 : 1;
+    if (x->kind != y->kind)
+        return x->kind == EVENT_FREE ? -1 : 1;
+    return (x->address > y->address) - (x->address < y->address);
+}
+
+/**
+ * qsort comparator: keys by address, then by time order
+ */
+static int compare_by_address(const void *a, const void *b)
+{
+    const AddressKey *x = (const AddressKey *)a;
+    const AddressKey *y = (const AddressKey *)b;
+
+    if (x->address != y->address)
+        return x->address < y->address ? -1 : 1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/**
+ * Bytes to simulator size units, rounded up (at least 1)
+ */
+static long long to_units(uint64_t bytes)
+{
+    long long units = (long long)((bytes + (uint64_t)config.unit - 1) / (uint64_t)config.unit);
+    return units > 0 ? units : 1;
+}
+
+/**
+ * Nanoseconds to time ticks, clamped to what the reader's %d accepts
+ */
+static int to_ticks(uint64_t nanoseconds)
+{
+    uint64_t ticks = nanoseconds / (uint64_t)config.tick_ns;
+    return ticks > INT_MAX ? INT_MAX : (int)ticks;
+}
+
+/**
+ * Match frees to allocations and write the trace
+ *
+ * Events are sorted by time to number allocations, then (address, position)
+ * keys are sorted by address: an allocation's lifetime ends at the next event on the same
+ * address if that event is a free. Allocations never freed during the
+ * capture live until it ended; frees of blocks allocated before the capture
+ * (or below MEMTRACE_MIN_BYTES) match nothing and are dropped.
+ */
+__attribute__((destructor)) static void memtrace_finish(void)
+{
+    if (!initialized)
+        return;
+
+    in_hook = true;
+    bool truncated = !capturing;
+    stop_capture();
+
+    pthread_mutex_lock(&chunk_lock);
+    size_t total = 0;
+    for (EventChunk *chunk = chunk_list; chunk != NULL; chunk = chunk->next)
+        total += (size_t)chunk->count;
+
+    TraceEvent *events = real_malloc((total > 0 ? total : 1) * sizeof(TraceEvent));
+    AddressKey *order = real_malloc((total > 0 ? total : 1) * sizeof(AddressKey));
+    uint64_t *end_ns = real_malloc((total > 0 ? total : 1) * sizeof(uint64_t));
+    if (events == NULL || order == NULL || end_ns == NULL)
+    {
+        pthread_mutex_unlock(&chunk_lock);
+        fprintf(stderr, "Error: memtrace could not allocate %zu events for matching\n", total);
+        return;
+    }
+
+    // Threads still running may have added events since the count
+    size_t n = 0;
+    for (EventChunk *chunk = chunk_list; chunk != NULL && n < total; chunk = chunk->next)
+    {
+        size_t count = (size_t)chunk->count;
+        if (count > total - n)
+            count = total - n;
+        memcpy(events + n, chunk->events, count * sizeof(TraceEvent));
+        n += count;
+    }
+    total = n;
+    pthread_mutex_unlock(&chunk_lock);
+
+    qsort(events, total, sizeof(TraceEvent), compare_by_time);
+    for (size_t i = 0; i < total; i++)
+    {
+        order[i].address = events[i].address;
+        order[i].index = i;
+        end_ns[i] = capture_end_ns;
+    }
+    qsort(order, total, sizeof(AddressKey), compare_by_address);
+
+    // Pair each allocation with the free that follows it on the same address;
+    // a matched free's end_ns slot holds the index of its allocation
+    for (size_t k = 0; k < total; k++)
+    {
+        size_t i = order[k].index;
+        if (events[i].kind == EVENT_FREE)
+            end_ns[i] = UINT64_MAX;
+        if (events[i].kind != EVENT_ALLOC || k + 1 == total)
+            continue;
+
+        size_t j = order[k + 1].index;
+        if (events[j].address == events[i].address && events[j].kind == EVENT_FREE)
+        {
+            end_ns[i] = events[j].time_ns;
+            end_ns[j] = i;
+            k++;
+        }
+    }
+
+    // Peak live memory, in units, sizes the simulated pool
+    long long live = 0, peak = 0;
+    size_t allocations = 0;
+    for (size_t i = 0; i < total; i++)
+    {
+        if (events[i].kind == EVENT_ALLOC)
+        {
+            live += to_units(events[i].size);
+            allocations++;
+        }
+        else if (end_ns[i] != UINT64_MAX)
+        {
+            live -= to_units(events[end_ns[i]].size);
+        }
+        if (live > peak)
+            peak = live;
+    }
+
+    // Expand "%p" in the file name
+    char path[MAX_PATH_LENGTH];
+    const char *marker = strstr(config.file, "%p");
+    if (marker != NULL)
+        snprintf(path, sizeof(path), "%.*s%d%s", (int)(marker - config.file), config.file, (int)getpid(), marker + 2);
+    else
+        snprintf(path, sizeof(path), "%s", config.file);
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: memtrace could not open trace file '%s'\n", path);
+    }
+    else
+    {
+        fprintf(file, "%lld\n", peak > 0 ? peak : 1);
+        fprintf(file, "# memtrace: %zu allocations from pid %d, unit %lld bytes, tick %lld ns%s\n",
+                allocations, (int)getpid(), config.unit, config.tick_ns,
+                truncated ? ", capture stopped at MEMTRACE_MAX_EVENTS" : "");
+        fprintf(file, "# ID Size Arrival Duration\n");
+
+        int id = 0;
+        for (size_t i = 0; i < total && id < INT_MAX; i++)
+        {
+            if (events[i].kind != EVENT_ALLOC)
+                continue;
+
+            fprintf(file, "%d %lld %d %d\n", ++id, to_units(events[i].size),
+                    to_ticks(events[i].time_ns - config.start_ns),
+                    to_ticks(end_ns[i] > events[i].time_ns ? end_ns[i] - events[i].time_ns : 0));
+        }
+        fclose(file);
+    }
+
+    real_free(end_ns);
+    real_free(order);
+    real_free(events);
+}